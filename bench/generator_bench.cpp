@@ -0,0 +1,391 @@
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include "protocol.hpp"
+#include "cppbuilder.hpp"
+#include "directbuilder.hpp"
+
+// CPP
+#include "cpp/arena.hpp"
+#include "cpp/transform/text.hpp"
+
+namespace fs = std::filesystem;
+namespace pt = boost::property_tree;
+namespace wg = wayland::generator;
+
+/**
+ * Measures every generator phase separately:
+ *   read_xml         - boost::property_tree::read_xml of the specification
+ *   create_from_xml  - WLProtocol::create_from_xml over the property tree
+ *   stream_parse     - WLProtocol::load_mapped, mmap and streaming parser (replacement of the two above)
+ *   build            - Builder::build_tree for every interface
+ *   format           - Builder::format of every tree into cpp::formatter::text
+ *   direct           - DirectBuilder::build of every interface, replacement of the two above
+ *   to_file          - writing every header
+ * Each input set is measured --iterations times, minimum and median are reported.
+ * build, format and direct are also timed per interface, --slowest interfaces with the longest build are reported.
+ */
+class BenchArgs {
+public:
+    BenchArgs(int argc, char *argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            if (!arg.starts_with("--")) {
+                throw std::runtime_error(std::format("Argument '{}' is not an option or option value!", arg));
+            }
+
+            arg.erase(0, 2);
+
+            if (arg == "arena") {
+                arena = true;
+                continue;
+            }
+
+            if (arg == "help") {
+                help = true;
+                break;
+            }
+
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::format("Cannot find value for option: '{}'", arg));
+            }
+            if (arg == "config") {
+                configs.emplace_back(argv[++i]);
+            } else if (arg == "protocols") {
+                protocol_dirs.emplace_back(argv[++i]);
+            } else if (arg == "output") {
+                output = argv[++i];
+            } else if (arg == "iterations") {
+                iterations = to_number(arg, argv[++i]);
+            } else if (arg == "synthetic-interfaces") {
+                synthetic_interfaces = to_number(arg, argv[++i]);
+            } else if (arg == "synthetic-messages") {
+                synthetic_messages = to_number(arg, argv[++i]);
+            } else if (arg == "slowest") {
+                slowest = to_number(arg, argv[++i]);
+            } else {
+                throw std::runtime_error(std::format("Option '{}' is not supported!", arg));
+            }
+        }
+
+        // Pinned upstream releases are default, numbers of system files depend on installed versions.
+        if (configs.empty()) {
+            configs.emplace_back(fs::path(WAYLANDCPP_GENERATOR_BENCH_WAYLAND) / "protocol" / "wayland.xml");
+        }
+        if (protocol_dirs.empty()) {
+            for (const auto* kind : { "stable", "staging", "unstable" }) {
+                protocol_dirs.emplace_back(fs::path(WAYLANDCPP_GENERATOR_BENCH_WAYLAND_PROTOCOLS) / kind);
+            }
+        }
+        iterations = std::max<std::size_t>(iterations, 1);
+    }
+
+    std::vector<fs::path> configs;
+    std::vector<fs::path> protocol_dirs;
+    fs::path output = fs::temp_directory_path() / "waylandcpp-generator-bench";
+    std::size_t iterations = 5;
+    // 0 disables synthetic protocol.
+    std::size_t synthetic_interfaces = 2000;
+    std::size_t synthetic_messages = 16;
+    // Interfaces with the longest build reported per input set.
+    std::size_t slowest = 10;
+    bool arena = false;
+    bool help = false;
+
+private:
+    static std::size_t to_number(const std::string& option, const std::string& value) {
+        try {
+            return std::stoul(value);
+        } catch (const std::exception&) {
+            throw std::runtime_error(std::format("Option '{}' expects a number, got: '{}'", option, value));
+        }
+    }
+};
+
+struct InputSet {
+    std::string           name;
+    std::vector<fs::path> files;
+};
+
+static std::vector<fs::path> find_specifications(const fs::path& dir) {
+    std::vector<fs::path> found;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+            found.push_back(entry.path());
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+// Protocol with every argument type, so all builder paths are exercised.
+static void write_synthetic_protocol(const fs::path& path, std::size_t interfaces, std::size_t messages) {
+    static const char* const arg_types[] = { "int", "uint", "fixed", "string", "object", "new_id", "array", "fd" };
+
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<protocol name=\"synthetic\">\n";
+    xml += "  <copyright>\n    Generated by waylandcpp-generator-bench.\n  </copyright>\n";
+    for (std::size_t i = 0; i < interfaces; ++i) {
+        xml += std::format("  <interface name=\"synthetic_{}\" version=\"3\">\n", i);
+        xml += std::format("    <description summary=\"synthetic interface {}\">\n      Interface &amp; its messages.\n    </description>\n", i);
+        xml += "    <enum name=\"error\">\n";
+        xml += "      <entry name=\"invalid\" value=\"0\" summary=\"invalid\"/>\n";
+        xml += "      <entry name=\"busy\" value=\"1\" summary=\"busy\"/>\n";
+        xml += "    </enum>\n";
+        for (std::size_t m = 0; m < messages; ++m) {
+            const char* kind = m % 2 == 0 ? "request" : "event";
+            xml += std::format("    <{} name=\"message_{}\" since=\"{}\">\n", kind, m, 1 + m % 3);
+            xml += std::format("      <description summary=\"message {}\">\n        Message text.\n      </description>\n", m);
+            for (std::size_t a = 0; a <= m % std::size(arg_types); ++a) {
+                std::string type = arg_types[(m + a) % std::size(arg_types)];
+                if (type == "new_id" && kind == std::string("event")) {
+                    type = "object";
+                }
+                xml += std::format("      <arg name=\"arg_{}\" type=\"{}\"", a, type);
+                if (type == "object" || type == "new_id") {
+                    xml += std::format(" interface=\"synthetic_{}\"", (i + 1) % interfaces);
+                }
+                xml += std::format(" summary=\"argument {}\"/>\n", a);
+            }
+            xml += std::format("    </{}>\n", kind);
+        }
+        xml += "  </interface>\n";
+    }
+    xml += "</protocol>\n";
+
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    out.write(xml.data(), xml.size());
+}
+
+using clock_type = std::chrono::steady_clock;
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(std::vector<double>& samples) : samples(samples), start(clock_type::now()) {}
+    ~PhaseTimer() {
+        samples.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - start).count());
+    }
+
+private:
+    std::vector<double>&   samples;
+    clock_type::time_point start;
+};
+
+// Per interface phases, keyed by "<protocol>/<interface>".
+struct InterfaceSamples {
+    std::vector<double> build;
+    std::vector<double> format;
+    std::vector<double> direct;
+};
+
+struct PhaseSamples {
+    std::map<std::string, InterfaceSamples> interfaces;
+    std::vector<double> read_xml;
+    std::vector<double> create_from_xml;
+    std::vector<double> stream_parse;
+    std::vector<double> build;
+    std::vector<double> format;
+    std::vector<double> direct;
+    std::vector<double> to_file;
+};
+
+static void run_iteration(const InputSet& set, const BenchArgs& args, wg::Builder& builder, const wg::DirectBuilder& direct, PhaseSamples& samples) {
+    std::vector<pt::ptree> trees(set.files.size());
+    {
+        PhaseTimer timer(samples.read_xml);
+        for (std::size_t i = 0; i < set.files.size(); ++i) {
+            pt::read_xml(set.files[i].string(), trees[i]);
+        }
+    }
+    {
+        PhaseTimer timer(samples.create_from_xml);
+        for (const auto& tree : trees) {
+            wg::WLProtocol::create_from_xml(tree);
+        }
+    }
+
+    std::vector<wg::WLProtocol> protocols(set.files.size());
+    {
+        PhaseTimer timer(samples.stream_parse);
+        for (std::size_t i = 0; i < set.files.size(); ++i) {
+            protocols[i] = wg::WLProtocol::load_mapped(set.files[i]);
+        }
+    }
+
+    std::optional<cpp::arena_scope> arena;
+    if (args.arena) {
+        arena.emplace();
+    }
+
+    // Phase totals include per interface timers, steady_clock reads are negligible next to building a header.
+    std::vector<InterfaceSamples*> per_interface;
+    for (const auto& protocol : protocols) {
+        for (const auto& interface : protocol.interfaces) {
+            per_interface.push_back(&samples.interfaces[std::format("{}/{}", protocol.name, interface.name)]);
+        }
+    }
+
+    std::vector<cpp::namespace_t> trees_cpp;
+    {
+        PhaseTimer timer(samples.build);
+        for (const auto& protocol : protocols) {
+            for (const auto& interface : protocol.interfaces) {
+                PhaseTimer interface_timer(per_interface[trees_cpp.size()]->build);
+                trees_cpp.push_back(builder.build_tree(interface));
+            }
+        }
+    }
+
+    std::vector<cpp::formatter::text> texts;
+    texts.reserve(trees_cpp.size());
+    {
+        PhaseTimer timer(samples.format);
+        for (const auto& ns : trees_cpp) {
+            PhaseTimer interface_timer(per_interface[texts.size()]->format);
+            texts.push_back(builder.format(ns));
+        }
+    }
+
+    {
+        PhaseTimer timer(samples.direct);
+        std::size_t index = 0;
+        for (const auto& protocol : protocols) {
+            for (const auto& interface : protocol.interfaces) {
+                PhaseTimer interface_timer(per_interface[index++]->direct);
+                direct.build(interface);
+            }
+        }
+    }
+
+    std::vector<fs::path> headers;
+    for (const auto& protocol : protocols) {
+        for (const auto& interface : protocol.interfaces) {
+            auto header = args.output / set.name / protocol.name / interface.name;
+            header.replace_extension("hpp");
+            fs::create_directories(header.parent_path());
+            headers.push_back(header);
+        }
+    }
+    {
+        PhaseTimer timer(samples.to_file);
+        for (std::size_t i = 0; i < texts.size(); ++i) {
+            texts[i].to_file(headers[i]);
+        }
+    }
+}
+
+static void report(const std::string& set, const std::string& phase, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::format("{:<12} {:<16} {:>12.3f} {:>12.3f}\n", set, phase, samples.front(), samples[samples.size() / 2]);
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Interfaces with the longest median build, with their format and direct medians to compare backends.
+static void report_slowest(const std::string& set, const std::map<std::string, InterfaceSamples>& interfaces, std::size_t count) {
+    std::vector<std::pair<std::string, std::array<double, 3>>> medians;
+    for (const auto& [name, samples] : interfaces) {
+        medians.emplace_back(name, std::array{ median(samples.build), median(samples.format), median(samples.direct) });
+    }
+    std::sort(medians.begin(), medians.end(), [](const auto& a, const auto& b) { return a.second[0] > b.second[0]; });
+    medians.resize(std::min(count, medians.size()));
+    for (const auto& [name, phases] : medians) {
+        std::cout << std::format("{:<12} {:<40} {:>12.3f} {:>12.3f} {:>12.3f}\n", set, name, phases[0], phases[1], phases[2]);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    BenchArgs args(argc, argv);
+
+    if (args.help) {
+        std::cout << "C++ wayland header generator benchmark:\n";
+        std::cout << "  --help show this help message\n";
+        std::cout << "  --config wayland specification xml, defaults to protocol/wayland.xml of wayland 1.22.0 fetched by cmake, can be repeated\n";
+        std::cout << "  --protocols directory with specification xmls, defaults to stable, staging and unstable of wayland-protocols 1.32 fetched by cmake, can be repeated\n";
+        std::cout << "  --output directory for generated headers, defaults to <TMP>/waylandcpp-generator-bench\n";
+        std::cout << "  --iterations number of measured runs of every input set, defaults to 5\n";
+        std::cout << "  --synthetic-interfaces number of interfaces of synthetic protocol, 0 disables it, defaults to 2000\n";
+        std::cout << "  --synthetic-messages number of requests and events of every synthetic interface, defaults to 16\n";
+        std::cout << "  --slowest number of interfaces with the longest build reported per input set with median build, format and direct time, 0 disables it, defaults to 10\n";
+        std::cout << "  --arena allocate syntax trees from arena" << std::endl;
+        return 0;
+    }
+
+    fs::create_directories(args.output);
+
+    std::vector<InputSet> sets;
+    if (!args.configs.empty()) {
+        sets.push_back({ "core", args.configs });
+    }
+    InputSet protocols{ "protocols", {} };
+    for (const auto& dir : args.protocol_dirs) {
+        auto found = find_specifications(dir);
+        protocols.files.insert(protocols.files.end(), found.begin(), found.end());
+    }
+    if (!protocols.files.empty()) {
+        sets.push_back(protocols);
+    }
+    if (args.synthetic_interfaces > 0) {
+        auto synthetic = args.output / "synthetic.xml";
+        write_synthetic_protocol(synthetic, args.synthetic_interfaces, args.synthetic_messages);
+        sets.push_back({ "synthetic", { synthetic } });
+    }
+
+    std::vector<cpp::include_t> includes;
+    includes.push_back(cpp::AngleInclusion("string"));
+    includes.push_back(cpp::AngleInclusion("vector"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/types.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/socket.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/object_builder.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/buffer_parser.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/callback.hpp"));
+
+    wg::Builder::Options options;
+    options.arena = args.arena;
+    wg::Builder builder(includes, options);
+    wg::DirectBuilder direct(includes);
+
+    std::cout << std::format("{:<12} {:<16} {:>12} {:>12}\n", "set", "phase", "min ms", "median ms");
+    std::vector<std::pair<std::string, std::map<std::string, InterfaceSamples>>> slowest;
+    for (const auto& set : sets) {
+        PhaseSamples samples;
+        // Warm up page cache and allocator before measuring.
+        PhaseSamples warm_up;
+        run_iteration(set, args, builder, direct, warm_up);
+        for (std::size_t i = 0; i < args.iterations; ++i) {
+            run_iteration(set, args, builder, direct, samples);
+        }
+
+        report(set.name, "read_xml", samples.read_xml);
+        report(set.name, "create_from_xml", samples.create_from_xml);
+        report(set.name, "stream_parse", samples.stream_parse);
+        report(set.name, "build", samples.build);
+        report(set.name, "format", samples.format);
+        report(set.name, "direct", samples.direct);
+        report(set.name, "to_file", samples.to_file);
+        slowest.emplace_back(set.name, std::move(samples.interfaces));
+    }
+
+    if (args.slowest > 0) {
+        std::cout << std::format("\n{:<12} {:<40} {:>12} {:>12} {:>12}\n", "set", "interface", "build ms", "format ms", "direct ms");
+        for (const auto& [set, interfaces] : slowest) {
+            report_slowest(set, interfaces, args.slowest);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+
+namespace cpp {
+    // Resource statements are allocated from on the current thread, global heap unless arena_scope is active.
+    inline std::pmr::memory_resource*& current_resource() {
+        thread_local std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+        return resource;
+    }
+
+    // While alive, statements created on this thread with make_node live in one monotonic arena
+    // and are released together when scope ends. Nodes must not outlive the scope.
+    // First block of the arena is allocated once per thread and reused by following outermost scopes,
+    // nested scopes start with a block of their own, as nodes of the outer scope still occupy the shared one.
+    class arena_scope {
+    public:
+        static constexpr std::size_t block_size = 256 * 1024;
+
+        arena_scope() : previous(current_resource()) {
+            if (depth() == 0) {
+                arena.emplace(thread_block(), block_size, std::pmr::new_delete_resource());
+            } else {
+                arena.emplace(block_size, std::pmr::new_delete_resource());
+            }
+            ++depth();
+            current_resource() = &*arena;
+        }
+
+        ~arena_scope() {
+            current_resource() = previous;
+            --depth();
+        }
+
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+    private:
+        static std::byte* thread_block() {
+            thread_local auto block = std::make_unique<std::byte[]>(block_size);
+            return block.get();
+        }
+
+        // Number of scopes alive on this thread.
+        static std::size_t& depth() {
+            thread_local std::size_t scopes = 0;
+            return scopes;
+        }
+
+        std::optional<std::pmr::monotonic_buffer_resource> arena;
+        std::pmr::memory_resource*                         previous;
+    };
+
+    // Plain allocator over a memory resource. Unlike polymorphic_allocator it doesn't do
+    // uses-allocator construction, nodes deriving from pmr containers pick current_resource() themselves.
+    template<typename T>
+    class node_allocator {
+    public:
+        using value_type = T;
+
+        explicit node_allocator(std::pmr::memory_resource* resource) : resource(resource) {}
+        template<typename U>
+        node_allocator(const node_allocator<U>& other) : resource(other.resource) {}
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            resource->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        template<typename U>
+        bool operator==(const node_allocator<U>& other) const { return resource == other.resource; }
+    private:
+        template<typename U>
+        friend class node_allocator;
+
+        std::pmr::memory_resource* resource;
+    };
+
+    // Node and its control block are allocated from current_resource().
+    template<typename T, typename ...Args>
+    std::shared_ptr<T> make_node(Args&& ...args) {
+        return std::allocate_shared<T>(node_allocator<T>(current_resource()), std::forward<Args>(args)...);
+    }
+}
@@ -18,6 +18,9 @@
 // base-clause - list of one or more base classes and the model of inheritance used for each.
 // member-specification - list of access specifiers, member object and member function declaration and definition.
 
+// Class template:
+// template < typename identifier, ... > class-key class-head-name ...
+
 // forward declaration
 // class-key identifier;
 
@@ -149,6 +152,11 @@ namespace cpp {
             member_specification_ = ms;
         }
 
+        // Makes class a template with type parameters of given names.
+        void set_template_parameters(const std::vector<std::string>& template_parameters) {
+            template_parameters_ = template_parameters;
+        }
+
         const auto& class_head_name() const { return class_head_name_; }
         auto class_key() const { return class_key_; }
 
@@ -174,6 +182,21 @@ namespace cpp {
         }
 
         void sequential_all(auto&& action) const {
+            if (!template_parameters_.empty()) {
+                action(language::template_keyword);
+                action(language::open_angle);
+                for (auto it = template_parameters_.begin(); it != template_parameters_.end(); ++it) {
+                    if (it != template_parameters_.begin()) {
+                        action(language::comma);
+                        action(language::space);
+                    }
+                    action(language::typename_keyword);
+                    action(language::space);
+                    action(*it);
+                }
+                action(language::close_angle);
+                action(language::newline);
+            }
             class_key_apply(class_key(), action);
             action(language::space);
             action(class_head_name_);
@@ -193,6 +216,7 @@ namespace cpp {
     private:
         std::string                           class_head_name_;
         class_key_t                           class_key_;
+        std::vector<std::string>              template_parameters_;
         std::optional<base_clause_t>          base_clause_;
         std::optional<member_specification_t> member_specification_;
     };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <variant>
 #include <string>
 
@@ -8,19 +9,30 @@
 #include "cpp/specification.hpp"
 
 namespace cpp {
+    // Closed set of identifiers, kind tells formatter which one it is without RTTI casts.
     class general_id_t {
     public:
+        enum class kind_t {
+            UNQUALIFIED,
+            QUALIFIED
+        };
+
+        explicit general_id_t(kind_t kind) : kind_(kind) {}
         virtual ~general_id_t() {}
+
+        kind_t kind() const { return kind_; }
+    private:
+        kind_t kind_;
     };
     using general_id_ptr = std::shared_ptr<general_id_t>;
 
     // just name that is declared
     class unqualified_id_t : public general_id_t {
     public:
-        unqualified_id_t() = default;
-        unqualified_id_t(const std::string& id) : id_(id) {}
+        unqualified_id_t() : general_id_t(kind_t::UNQUALIFIED) {}
+        unqualified_id_t(const std::string& id) : general_id_t(kind_t::UNQUALIFIED), id_(id) {}
 
-        unqualified_id_t(const unqualified_id_t& unqid) {
+        unqualified_id_t(const unqualified_id_t& unqid) : general_id_t(kind_t::UNQUALIFIED) {
             *this = unqid;
         }
 
@@ -39,7 +51,10 @@ namespace cpp {
     // Declaration that uses qualified identifier
     class qualified_id_t : public general_id_t {
     public:
-        qualified_id_t(auto prefix, unqid_t unqid) : prefix_(std::make_shared<decltype(prefix)>(prefix)), id_(unqid) {}
+        qualified_id_t(auto prefix, unqid_t unqid)
+            : general_id_t(kind_t::QUALIFIED),
+              prefix_(std::make_shared<decltype(prefix)>(prefix)),
+              id_(unqid) {}
 
         const auto& id() const { return id_; }
         const auto& prefix() const { return prefix_; }
@@ -1,22 +1,44 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
+#include <vector>
 
 #include "cpp/declaration/initializer.hpp"
 #include "cpp/declaration/simple_declarator.hpp"
 #include "cpp/symbols.hpp"
 #include "cpp/keywords.hpp"
 #include "cpp/format.hpp"
+#include "cpp/arena.hpp"
 
 namespace cpp {
 
+    // Set of statements is closed, kind tells formatter which one it is without RTTI casts.
     class statement_t {
     public:
+        enum class kind_t {
+            LABEL,
+            EXPRESSION,
+            COMPOUND,
+            IF,
+            SWITCH,
+            WHILE,
+            FOR,
+            RANGE_FOR,
+            JUMP
+        };
+
+        explicit statement_t(kind_t kind) : kind_(kind) {}
         virtual ~statement_t() {}
+
+        kind_t kind() const { return kind_; }
+    private:
+        kind_t kind_;
     };
 
     using statement_ptr = std::shared_ptr<statement_t>;
-    using statement_vec = std::vector<statement_ptr>;
+    // Allocated from current_resource(), see arena_scope.
+    using statement_vec = std::pmr::vector<statement_ptr>;
 
     // C++ includes following types of statements:
     // 1) labeled statements;  <- needed for case
@@ -39,9 +61,10 @@ namespace cpp {
             DEFAULT
         };
 
-        label_statement_t() : label_type_(label_t::DEFAULT) {}
+        label_statement_t() : statement_t(kind_t::LABEL), label_type_(label_t::DEFAULT) {}
         explicit label_statement_t(label_t label_type = label_t::DEFAULT, const std::string& label = "")
-        : label_type_(label_type),
+        : statement_t(kind_t::LABEL),
+          label_type_(label_type),
           label_(label) {}
         auto label_type() const { return label_type_; }
         const auto& label() const { return label_; }
@@ -75,8 +98,8 @@ namespace cpp {
     class expression_statement_t : public statement_t {
     public:
         static constexpr auto trailer = language::semi_collon_t {};
-        explicit expression_statement_t(const std::string& expr) : expression_(expr) {}
-        explicit expression_statement_t(expression_t expression) : expression_(expression) {}
+        explicit expression_statement_t(const std::string& expr) : statement_t(kind_t::EXPRESSION), expression_(expr) {}
+        explicit expression_statement_t(expression_t expression) : statement_t(kind_t::EXPRESSION), expression_(expression) {}
          
         auto& expression() { return expression_; }
         const auto& expression() const { return expression_; }
@@ -91,6 +114,14 @@ namespace cpp {
     // { statement... }
     class compound_statement_t : public statement_t, public statement_vec {
     public:
+        compound_statement_t() : statement_t(kind_t::COMPOUND), statement_vec(current_resource()) {}
+        compound_statement_t(const compound_statement_t& other)
+            : statement_t(other), statement_vec(other, current_resource()) {}
+        compound_statement_t(compound_statement_t&& other)
+            : statement_t(other), statement_vec(std::move(other), current_resource()) {}
+        compound_statement_t& operator=(const compound_statement_t&) = default;
+        compound_statement_t& operator=(compound_statement_t&&) = default;
+
         void sequential_all(auto&& action) const {
             const statement_vec& vec = *this;
             action(language::open_curly_brace);
@@ -118,11 +149,13 @@ namespace cpp {
     class if_statement_t : public statement_t, statement_vec {
     public:
         explicit if_statement_t(condition_t condition, statement_ptr statement)
-            : condition_(condition),
+            : statement_t(kind_t::IF),
+              condition_(condition),
               statement_(statement) {}
 
         explicit if_statement_t(init_statement_t init_statement, condition_t condition, statement_ptr statement)
-            : init_statement_(init_statement),
+            : statement_t(kind_t::IF),
+              init_statement_(init_statement),
               condition_(condition),
               statement_(statement) {}
 
@@ -146,11 +179,13 @@ namespace cpp {
     class switch_statement_t : public statement_t {
     public:
         explicit switch_statement_t(condition_t condition, statement_ptr statement)
-            : condition_(condition),
+            : statement_t(kind_t::SWITCH),
+              condition_(condition),
               statement_(statement) {}
 
         explicit switch_statement_t(init_statement_t init_statement, condition_t condition, statement_ptr statement)
-            : init_statement_(init_statement),
+            : statement_t(kind_t::SWITCH),
+              init_statement_(init_statement),
               condition_(condition),
               statement_(statement) {}
 
@@ -175,7 +210,8 @@ namespace cpp {
     class while_statement_t : public statement_t {
     public:
         explicit while_statement_t(condition_t condition, statement_ptr statement)
-            : condition_(condition),
+            : statement_t(kind_t::WHILE),
+              condition_(condition),
               statement_(statement) {}
         const auto& condition() const { return condition_; }
         const auto& statement() const { return statement_; }
@@ -197,11 +233,13 @@ namespace cpp {
     class for_statement_t : public statement_t {
     public:
         explicit for_statement_t(init_statement_t init_statement, statement_ptr statement)
-            : init_statement_(init_statement),
+            : statement_t(kind_t::FOR),
+              init_statement_(init_statement),
               statement_(statement) {}
 
         explicit for_statement_t(init_statement_t init_statement, condition_t condition, expression_t expression, statement_ptr statement)
-            : init_statement_(init_statement),
+            : statement_t(kind_t::FOR),
+              init_statement_(init_statement),
               condition_(condition),
               expression_(condition),
               statement_(statement) {}
@@ -227,9 +265,32 @@ namespace cpp {
         statement_ptr               statement_;
     };
 
+    // for (range-declaration : range-initializer) statement, range is kept as one expression.
+    class range_for_statement_t : public statement_t {
+    public:
+        explicit range_for_statement_t(expression_t range, statement_ptr statement)
+            : statement_t(kind_t::RANGE_FOR),
+              range_(range),
+              statement_(statement) {}
+
+        void sequential_all(auto&& action) const {
+            action(language::for_keyword);
+            action(language::open_brace);
+            action(range_);
+            action(language::close_brace);
+            action(language::newline);
+            action(statement_);
+        }
+
+    private:
+        expression_t  range_;
+        statement_ptr statement_;
+    };
+
     // while(condition) statement                                               (1)
     // for (init-statement condition(optional); expression(optional)) statement (2)
-    using iteration_statement_t = std::variant<while_statement_t, for_statement_t>;
+    // for (range-declaration : range-initializer) statement                    (3)
+    using iteration_statement_t = std::variant<while_statement_t, for_statement_t, range_for_statement_t>;
 
     // break;                           (1)
     // continue;                        (2)
@@ -242,7 +303,7 @@ namespace cpp {
             CONTINUE,
             RETURN
         };
-        explicit jump_statement_t(jump_t jump_type) : jump_type_(jump_type) {}
+        explicit jump_statement_t(jump_t jump_type) : statement_t(kind_t::JUMP), jump_type_(jump_type) {}
         static auto return_statement(expression_t expression) {
             return jump_statement_t(jump_t::RETURN, expression);
         }
@@ -271,7 +332,8 @@ namespace cpp {
 
     private:
         jump_statement_t(jump_t jump_type, expression_t expression)
-            : jump_type_(jump_type),
+            : statement_t(kind_t::JUMP),
+              jump_type_(jump_type),
               expression_(expression) {}
         jump_t jump_type_;
         std::optional<expression_t> expression_;
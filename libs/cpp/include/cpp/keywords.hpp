@@ -154,6 +154,18 @@ namespace language {
         static constexpr std::string keyword = "using";
     };
 
+    class template_keyword_t {
+    public:
+        constexpr template_keyword_t() {}
+        static constexpr std::string keyword = "template";
+    };
+
+    class typename_keyword_t {
+    public:
+        constexpr typename_keyword_t() {}
+        static constexpr std::string keyword = "typename";
+    };
+
     using keyword_t = std::variant<static_keyword_t, extern_keyword_t,
                                    constexpr_keyword_t, volatile_keyword_t,
                                    const_keyword_t,
@@ -164,7 +176,8 @@ namespace language {
                                    break_keyword_t, continue_keyword_t, return_keyword_t,
                                    public_keyword_t, protected_keyword_t, private_keyword_t,
                                    namespace_keyword_t, class_keyword_t, struct_keyword_t, union_keyword_t, enum_keyword_t,
-                                   virtual_keyword_t, using_keyword_t>;
+                                   virtual_keyword_t, using_keyword_t,
+                                   template_keyword_t, typename_keyword_t>;
 
     static constexpr keyword_t static_keyword = static_keyword_t {};
     static constexpr keyword_t extern_keyword = extern_keyword_t {};
@@ -191,4 +204,6 @@ namespace language {
     static constexpr keyword_t enum_keyword = enum_keyword_t {};
     static constexpr keyword_t namespace_keyword = namespace_keyword_t {};
     static constexpr keyword_t using_keyword = using_keyword_t {};
+    static constexpr keyword_t template_keyword = template_keyword_t {};
+    static constexpr keyword_t typename_keyword = typename_keyword_t {};
 };
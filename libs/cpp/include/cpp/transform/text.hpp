@@ -1,10 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <ranges>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
-#include <ranges>
 #include <filesystem>
 #include <fstream>
 
@@ -16,10 +17,27 @@
 #include "cpp/declaration/statement.hpp"
 
 namespace cpp::formatter {
+    // Destination of streamed text, receives it in chunks of about buffer size, see text(sink&).
+    class sink {
+    public:
+        virtual ~sink() = default;
+        virtual void write(std::string_view chunk) = 0;
+    };
+
+    // Generated text is appended to one contiguous buffer, indentation prefix is cached and changes only with indentation level.
     class text {
     public:
+        static constexpr std::size_t initial_capacity = 16 * 1024;
+
         text() {
-            data.push_back("#pragma once\n");
+            data.reserve(initial_capacity);
+            data += "#pragma once\n";
+        }
+        // Streamed text: buffer is passed to out whenever it reaches capacity, so memory doesn't grow with text.
+        // Caller has to flush() at the end, str(), to_file() and update_file() see only the part not flushed yet.
+        explicit text(sink& out, std::size_t capacity = initial_capacity) : out(&out), capacity(capacity) {
+            data.reserve(capacity);
+            data += "#pragma once\n";
         }
         enum class ident_t {
             add,
@@ -28,10 +46,13 @@ namespace cpp::formatter {
 
         text& operator<<(const std::string& word) {
             if (!dirty) {
-                data.push_back(std::string(identation, ' '));
+                data += indentation_prefix;
                 dirty = true;
             }
-            data.push_back(word);
+            data += word;
+            if (out && data.size() >= capacity) {
+                flush();
+            }
             return *this;
         }
 
@@ -44,6 +65,7 @@ namespace cpp::formatter {
                     identation -= 4;
                     break;
             }
+            indentation_prefix.assign(std::max(identation, 0), ' ');
             return *this;
         }
 
@@ -52,21 +74,58 @@ namespace cpp::formatter {
         }
 
         void to_file(std::filesystem::path& path) {
-            std::ofstream out_file(path, std::ios::out);
-            out_file << *this;
+            std::ofstream out_file(path, std::ios::out | std::ios::binary);
+            out_file.write(data.data(), data.size());
+        }
+
+        const std::string& str() const {
+            return data;
+        }
+
+        // Passes buffered text to sink, no-op without one.
+        void flush() {
+            if (out && !data.empty()) {
+                out->write(data);
+                flushed += data.size();
+                data.clear();
+            }
+        }
+
+        // Size of the whole text, including flushed part.
+        std::size_t size() const {
+            return flushed + data.size();
+        }
+
+        // Writes file only when its content differs, so unchanged file keeps its mtime.
+        // Returns true if file was written.
+        bool update_file(const std::filesystem::path& path) const {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(path, ec);
+            if (!ec && size == data.size()) {
+                std::ifstream in_file(path, std::ios::in | std::ios::binary);
+                std::string existing(size, '\0');
+                if (in_file.read(existing.data(), existing.size()) && existing == data) {
+                    return false;
+                }
+            }
+            std::ofstream out_file(path, std::ios::out | std::ios::binary);
+            out_file.write(data.data(), data.size());
+            return true;
         }
 
         friend std::ostream& operator<<(std::ostream& out, const text& txt);
     private:
-        std::vector<std::string> data;
-        int                      identation = 0;
-        bool                     dirty = false;
+        std::string data;
+        sink*       out = nullptr;
+        std::size_t capacity = initial_capacity;
+        std::size_t flushed = 0;
+        std::string indentation_prefix;
+        int         identation = 0;
+        bool        dirty = false;
     };
 
     inline std::ostream& operator<<(std::ostream& out, const cpp::formatter::text& txt) {
-        for (auto& word: txt.data) {
-            out << word;
-        }
+        out.write(txt.data.data(), txt.data.size());
         return out;
     }
 
@@ -135,34 +194,54 @@ namespace cpp::formatter {
     }
 
     inline cpp::formatter::text& operator<<(cpp::formatter::text& text, const general_id_ptr& general_id) {
-        if (auto qual_ptr = std::dynamic_pointer_cast<qualified_id_t>(general_id); qual_ptr) {
-            text << *qual_ptr;
-        } else if (auto unqual_id = std::dynamic_pointer_cast<unqualified_id_t>(general_id); unqual_id) {
-            text << *unqual_id;
+        if (!general_id) {
+            return text;
         }
-        return text;
-    }
-
-    template<typename Derrived>
-    inline void do_if_derrived(const auto& el, auto&& func) {
-        if (auto&& derrived_ptr = std::dynamic_pointer_cast<Derrived>(el); derrived_ptr) {
-            func(*derrived_ptr);
+        switch (general_id->kind()) {
+            case general_id_t::kind_t::QUALIFIED:
+                text << static_cast<const qualified_id_t&>(*general_id);
+                break;
+            case general_id_t::kind_t::UNQUALIFIED:
+                text << static_cast<const unqualified_id_t&>(*general_id);
+                break;
         }
-    }
-
-    template<typename ...Derrived>
-    inline void do_for_all_derrived(const auto& el, auto&& func) {
-        (do_if_derrived<Derrived>(el, func),...);
+        return text;
     }
 
     inline cpp::formatter::text& operator<<(cpp::formatter::text& text, const cpp::statement_ptr& stmt) {
-        auto print = [&](auto&& keyword) { text << keyword; };
-        do_for_all_derrived<label_statement_t,
-                            expression_statement_t,
-                            compound_statement_t,
-                            switch_statement_t, if_statement_t,
-                            for_statement_t, while_statement_t,
-                            jump_statement_t>(stmt, print);
+        if (!stmt) {
+            return text;
+        }
+        using kind_t = statement_t::kind_t;
+        switch (stmt->kind()) {
+            case kind_t::LABEL:
+                text << static_cast<const label_statement_t&>(*stmt);
+                break;
+            case kind_t::EXPRESSION:
+                text << static_cast<const expression_statement_t&>(*stmt);
+                break;
+            case kind_t::COMPOUND:
+                text << static_cast<const compound_statement_t&>(*stmt);
+                break;
+            case kind_t::SWITCH:
+                text << static_cast<const switch_statement_t&>(*stmt);
+                break;
+            case kind_t::IF:
+                text << static_cast<const if_statement_t&>(*stmt);
+                break;
+            case kind_t::FOR:
+                text << static_cast<const for_statement_t&>(*stmt);
+                break;
+            case kind_t::RANGE_FOR:
+                text << static_cast<const range_for_statement_t&>(*stmt);
+                break;
+            case kind_t::WHILE:
+                text << static_cast<const while_statement_t&>(*stmt);
+                break;
+            case kind_t::JUMP:
+                text << static_cast<const jump_statement_t&>(*stmt);
+                break;
+        }
 
         return text;
     }
@@ -0,0 +1,42 @@
+#include <cstdlib>
+#include <new>
+
+#include "stats.hpp"
+
+// Global allocation functions replaced to feed --stats, counting is off until Stats is created.
+// Array and nothrow forms forward to these in the standard library.
+
+void* operator new(std::size_t size) {
+    wayland::generator::Stats::count_allocation(size);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    wayland::generator::Stats::count_allocation(size);
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires size to be multiple of alignment.
+    auto rounded = (size + align - 1) / align * align;
+    if (void* ptr = std::aligned_alloc(align, rounded == 0 ? align : rounded)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,67 @@
+#include "buildfiles.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace wayland::generator {
+    // Make escaping, which Ninja understands as well.
+    static std::string depfile_path(const std::filesystem::path& path) {
+        std::string escaped;
+        for (char c : path.string()) {
+            switch (c) {
+                case ' ':
+                case '#':
+                case '\\':
+                    escaped += '\\';
+                    break;
+                case '$':
+                    escaped += '$';
+                    break;
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    static void write_file(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream out(path, std::ios::out | std::ios::binary);
+        if (!out.write(content.data(), content.size())) {
+            throw std::runtime_error(std::format("Cannot write '{}'", path.string()));
+        }
+    }
+
+    void write_depfile(const std::filesystem::path& path, const std::vector<std::filesystem::path>& outputs,
+                       const std::vector<std::filesystem::path>& inputs) {
+        std::string content;
+        for (const auto& output : outputs) {
+            content += &output == &outputs.front() ? "" : " \\\n";
+            content += depfile_path(output);
+        }
+        content += ":";
+        for (const auto& input : inputs) {
+            content += " \\\n  ";
+            content += depfile_path(input);
+        }
+        content += "\n";
+        write_file(path, content);
+    }
+
+    void write_manifest(const std::filesystem::path& path, std::vector<ManifestEntry> entries) {
+        std::ranges::sort(entries, {}, &ManifestEntry::file);
+        std::string content;
+        for (const auto& entry : entries) {
+            std::format_to(std::back_inserter(content), "{:016x} {} {}\n", entry.hash, entry.bytes, entry.file.generic_string());
+        }
+
+        std::ifstream existing(path, std::ios::in | std::ios::binary);
+        if (existing && std::string(std::istreambuf_iterator<char>(existing), {}) == content) {
+            return;
+        }
+        existing.close();
+        write_file(path, content);
+    }
+}
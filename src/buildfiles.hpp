@@ -0,0 +1,26 @@
+#ifndef WAYLAND_GENERATOR_BUILDFILES_H
+#define WAYLAND_GENERATOR_BUILDFILES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace wayland::generator {
+    // Make/Ninja depfile: every output depends on every input, paths are written as given.
+    void write_depfile(const std::filesystem::path& path, const std::vector<std::filesystem::path>& outputs,
+                       const std::vector<std::filesystem::path>& inputs);
+
+    struct ManifestEntry {
+        // Relative to output directory.
+        std::filesystem::path file;
+        std::uint64_t         hash = 0;
+        std::size_t           bytes = 0;
+    };
+
+    // Line "<FNV-1a hash> <size> <file>" per generated file, sorted by file.
+    // Rewritten only when content changes, so its mtime changes only together with some output.
+    void write_manifest(const std::filesystem::path& path, std::vector<ManifestEntry> entries);
+}
+
+#endif /* WAYLAND_GENERATOR_BUILDFILES_H */
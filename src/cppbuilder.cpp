@@ -1,7 +1,10 @@
 #include <cctype>
 #include <set>
+#include <optional>
+#include <algorithm>
 
 #include "cppbuilder.hpp"
+#include "support.hpp"
 #include "cpp/declaration/simple_declarator.hpp"
 #include "cpp/comments.hpp"
 #include "cpp/declaration/enum.hpp"
@@ -10,22 +13,92 @@
 namespace wayland::generator {
     static cpp::unqid_t ns_prefix("wire");
 
-    inline bool is_essential(const std::string& interface) {
+    bool is_essential(std::string_view interface) {
         return interface == "wl_display" || interface == "wl_registry";
     }
 
-    std::string op_code_name(const std::string& orig) {
+    std::string op_code_name(std::string_view orig) {
         return std::format("{}_op", orig);
     }
 
-    std::string alias_type(const std::string& name) {
+    std::string alias_type(std::string_view name) {
         return std::format("{}_cb_t", name);
     }
 
-    std::string alias_name(const std::string& name) {
+    std::string alias_name(std::string_view name) {
         return std::format("{}_cb", name);
     }
 
+    std::string handlers_name(std::string_view interface) {
+        return std::format("{}_handlers", interface);
+    }
+
+    std::string decoder_name(std::string_view orig) {
+        return std::format("decode_{}", orig);
+    }
+
+    std::string header_name(std::string_view orig) {
+        return std::format("{}_header", orig);
+    }
+
+    std::string coalesce_name(std::string_view event) {
+        return std::format("coalesce_{}", event);
+    }
+
+    std::string pending_name(std::string_view event) {
+        return std::format("pending_{}", event);
+    }
+
+    static bool has_coalesce(const std::vector<Builder::Options::Coalesce>& coalesce, std::string_view interface) {
+        return std::ranges::any_of(coalesce, [&](const auto& entry) { return entry.interface == interface; });
+    }
+
+    // Only plain values can be kept until frame: strings and arrays may be views, new_id and fd have side effects.
+    static bool is_coalescable(wire_type type) {
+        return type == wire_type::INT || type == wire_type::UINT || type == wire_type::FIXED || type == wire_type::OBJECT;
+    }
+
+    // Strings and arrays have size known only at runtime, fds are passed out of band.
+    static bool is_variable_size(wire_type type) {
+        return type == wire_type::STRING || type == wire_type::ARRAY;
+    }
+
+    // new_id without interface (wl_registry.bind) is sent as interface name, version and id, see message_signature.
+    // Parameter which the function doesn't read stays unnamed, generated headers are built with -Wextra by users.
+    static cpp::unqid_t parameter_name(std::string_view name, bool used) {
+        return cpp::unqid_t(used ? std::string(name) : std::format("/*{}*/", name));
+    }
+
+    static bool pops_fds(const Builder::Options& options, const std::vector<WLArgument>& arguments) {
+        return options.fd_queue && std::ranges::any_of(arguments, [](const WLArgument& arg) { return arg.type == wire_type::FD; });
+    }
+
+    static bool parses_body(const Builder::Options& options, const std::vector<WLArgument>& arguments) {
+        return std::ranges::any_of(arguments, [&](const WLArgument& arg) { return !options.fd_queue || arg.type != wire_type::FD; });
+    }
+
+    static bool is_untyped_new_id(const WLArgument& arg) {
+        return arg.type == wire_type::NEW_ID && !arg.arg_interface;
+    }
+
+    // Request can be encoded into std::array of words.
+    static bool is_fixed_size(const std::vector<WLArgument>& arguments) {
+        return std::ranges::none_of(arguments, [](const WLArgument& arg) {
+            return is_variable_size(arg.type) || arg.type == wire_type::FD || is_untyped_new_id(arg);
+        });
+    }
+
+    // Size in bytes known at generation time: header, one word per argument and length word of strings and arrays.
+    static std::size_t static_wire_size(const std::vector<WLArgument>& arguments) {
+        std::size_t size = 2 * sizeof(wire_word_t);
+        for (const auto& arg : arguments) {
+            if (arg.type != wire_type::FD) {
+                size += sizeof(wire_word_t);
+            }
+        }
+        return size;
+    }
+
     cpp::specifier_t Builder::wire_to_type(wire_type type) {
         switch (type) {
             case wire_type::FD:
@@ -64,21 +137,102 @@ namespace wayland::generator {
         return void_type;
     }
 
-    cpp::formatter::text Builder::build(const wayland::generator::WLInterface& interface) {
+    cpp::specifier_t Builder::event_arg_type(wire_type type) {
+        if (options.view_args) {
+            static cpp::simple_type_specifier_t string_view_type("std::string_view");
+            static cpp::simple_type_specifier_t byte_span_type("std::span<const std::byte>");
+            if (type == wire_type::STRING) {
+                return string_view_type;
+            }
+            if (type == wire_type::ARRAY) {
+                return byte_span_type;
+            }
+        }
+        return wire_to_type(type);
+    }
+
+    std::string Builder::event_arg_type_name(wire_type type) {
+        auto specifier = event_arg_type(type);
+        if (auto simple = std::get_if<cpp::simple_type_specifier_t>(&specifier)) {
+            return simple->id();
+        }
+        auto qualified = std::get<cpp::qid_t>(specifier);
+        return std::format("{}::{}", ns_prefix.id(), qualified.id().id());
+    }
+
+    cpp::formatter::text Builder::build(const wayland::generator::WLInterface& interface, Stats::Interface* stats) {
+        cpp::formatter::text text;
+        build(interface, text, stats);
+        return text;
+    }
+
+    void Builder::build(const wayland::generator::WLInterface& interface, cpp::formatter::text& text, Stats::Interface* stats) {
+        // Has to outlive every AST node of the interface, so it is created first.
+        std::optional<cpp::arena_scope> arena;
+        if (options.arena) {
+            arena.emplace();
+        }
+
+        auto tree = [&] {
+            Stats::Timer timer(stats ? &stats->ast_build : nullptr);
+            return build_tree(interface);
+        }();
+
+        Stats::Timer timer(stats ? &stats->format : nullptr);
+        format(tree, text);
+    }
+
+    cpp::formatter::text Builder::format(const cpp::namespace_t& ns) {
         cpp::formatter::text text;
+        format(ns, text);
+        return text;
+    }
 
+    void Builder::format(const cpp::namespace_t& ns, cpp::formatter::text& text) {
         for (auto& include : common_includes) {
             text << include;
             text << language::newline;
         }
+        text << cpp::QuoteInclusion("waylandcpp/wire/metadata.hpp");
+        text << language::newline;
+        for (auto header : { "array", "string_view" }) {
+            text << cpp::AngleInclusion(header);
+            text << language::newline;
+        }
+        if (options.view_args) {
+            for (auto header : { "cstddef", "span" }) {
+                text << cpp::AngleInclusion(header);
+                text << language::newline;
+            }
+        }
+        if (options.fd_queue) {
+            text << cpp::QuoteInclusion("waylandcpp/wire/fd_ring.hpp");
+            text << language::newline;
+        }
+        if (!options.coalesce.empty()) {
+            for (auto header : { "optional", "tuple", "utility" }) {
+                text << cpp::AngleInclusion(header);
+                text << language::newline;
+            }
+        }
         text << language::newline;
 
+        text << ns;
+    }
 
-        cpp::clas cl(interface.name);
+    cpp::namespace_t Builder::build_tree(const wayland::generator::WLInterface& interface) {
+        cpp::clas cl(std::string(interface.name));
+        if (options.crtp) {
+            cl.set_template_parameters({ "Handler" });
+        }
         cl.append(cpp::public_access);
 
-        for (auto& cb_type : gen_callback_types(interface.events)) {
-            cl.append(cb_type);
+        if (options.compact) {
+            cl.append(cpp::type_alias_t("handlers_t", handlers_name(interface.name)));
+        } else if (!options.crtp) {
+            for (auto& cb_type : gen_callback_types(interface.events)) {
+                cl.append(cb_type);
+            }
         }
 
         auto sock = cpp::unqid_t("sock");
@@ -101,17 +255,42 @@ namespace wayland::generator {
         for (auto& event : gen_events(interface.events)) {
             cl.append(event);
         }
-        cl.append(gen_dispatcher(interface.events));
+        if (options.table_dispatch) {
+            for (auto& dispatcher : gen_table_dispatcher()) {
+                cl.append(dispatcher);
+            }
+        } else {
+            cl.append(gen_dispatcher(interface));
+        }
 
         cl.append(language::comment_t("Utility"));
         for (auto& utility : gen_utility(interface)) {
             cl.append(utility);
         }
+        for (auto& flush : gen_flush_coalesced(interface)) {
+            cl.append(flush);
+        }
 
         cl.append(cpp::protected_access);
         for (auto& var : gen_variables(interface)) {
             cl.append(var);
         }
+        for (auto& var : gen_coalesce_variables(interface)) {
+            cl.append(var);
+        }
+        for (auto& method : gen_coalesce_methods(interface)) {
+            cl.append(method);
+        }
+        if (options.table_dispatch) {
+            cl.append(cpp::type_alias_t("decoder_t", std::format("void (*)({} &, wire::WireBufferParser &{})", interface.name, options.fd_queue ? ", wire::FdRing &" : "")));
+            for (auto& decoder : gen_decoders(interface)) {
+                cl.append(decoder);
+            }
+            cl.append(gen_decoder_table(interface));
+        }
+        if (options.crtp) {
+            cl.append(gen_handler_accessor());
+        }
 
         cl.append(cpp::public_access);
         for (auto& var : gen_public_const(interface)) {
@@ -119,39 +298,29 @@ namespace wayland::generator {
         }
 
         cpp::namespace_t ns("waylandcpp::interface");
+        if (options.compact) {
+            ns.push_back(gen_handlers(interface));
+        }
         ns.push_back(cl);
 
-        text << ns;
-
-        return text;
+        return ns;
     }
 
-    cpp::compound_statement_t Builder::gen_request_body(const cpp::function_declaration_t& req) {
-        auto shared_expr = [](auto s) { return std::make_shared<cpp::expression_statement_t>(s); };
+    cpp::compound_statement_t Builder::gen_request_body(const WLRequest& request) {
+        auto shared_expr = [](auto s) { return cpp::make_node<cpp::expression_statement_t>(s); };
         cpp::compound_statement_t body;
-        auto op_name = op_code_name(std::get<cpp::unqid_t>(req.noptr_decl()).id());
-        auto object_builder_def = shared_expr(std::format("wire::WireObjectBuilder builder(id_, {})", op_name).c_str());
-        static const auto write = shared_expr("sock.write(builder.data(), builder.size())");
+        auto object_builder_def = shared_expr(std::format("wire::WireObjectBuilder builder(id_, {})", op_code_name(request.name)));
+        // Not shared between bodies: node may live in the arena of the interface being built.
+        auto write = shared_expr(send_message("builder.data()", "builder.size()"));
 
         body.push_back(object_builder_def);
 
-        if (req.param_list().size() > 0) {
-            std::stringstream ss;
-            ss << "builder.add(";
-            auto pl = req.param_list();
-            auto it = pl.begin();
-            ss << std::get<cpp::unqid_t>(it->init_decl().declarator()).id();
-            while (++it != pl.end()) {
-                auto name = std::get<cpp::unqid_t>(it->init_decl().declarator()).id();
-                ss << ", " << name;
-            }
-            //bool comma = false;
-            //for (const auto& p : req.param_list()) {
-            //    ss << (comma? ", " : "") << p.name();
-            //    comma = true;
-            //}
-            ss << ")";
-            body.push_back(shared_expr(ss.str()));
+        auto names = added_arguments(request);
+        if (!names.empty()) {
+            body.push_back(shared_expr(std::format("builder.add({})", names)));
+        }
+        for (const auto& statement : gen_queue_fds(request)) {
+            body.push_back(statement);
         }
 
         body.push_back(write);
@@ -159,12 +328,105 @@ namespace wayland::generator {
         return body;
     }
 
-    cpp::parameter_list_t Builder::gen_parameters(const std::vector<WLArgument>& args) {
+    std::string Builder::added_arguments(const WLRequest& request) const {
+        std::string names;
+        for (const auto& arg : request.arguments) {
+            // Queued descriptors travel out of band, they are not part of the message.
+            if (options.fd_queue && arg.type == wire_type::FD) {
+                continue;
+            }
+            names += names.empty() ? std::string(arg.name) : std::format(", {}", arg.name);
+        }
+        return names;
+    }
+
+    cpp::compound_statement_t Builder::gen_queue_fds(const WLRequest& request) {
+        cpp::compound_statement_t queue;
+        if (!options.fd_queue) {
+            return queue;
+        }
+        for (const auto& arg : request.arguments) {
+            if (arg.type == wire_type::FD) {
+                queue.push_back(cpp::make_node<cpp::expression_statement_t>(std::format("sock.queue_fd({})", arg.name)));
+            }
+        }
+        return queue;
+    }
+
+    cpp::compound_statement_t Builder::gen_static_request_body(const WLRequest& request) {
+        auto shared_expr = [](const std::string& s) { return cpp::make_node<cpp::expression_statement_t>(s); };
+        cpp::compound_statement_t body;
+        auto size = static_wire_size(request.arguments);
+
+        if (is_fixed_size(request.arguments)) {
+            std::string words = std::format("id_, {}", header_name(request.name));
+            for (const auto& arg : request.arguments) {
+                if (arg.type == wire_type::INT || arg.type == wire_type::FIXED) {
+                    words += std::format(", static_cast<wire::wire_word_t>({})", arg.name);
+                } else {
+                    words += std::format(", {}", arg.name);
+                }
+            }
+            body.push_back(shared_expr(std::format("const std::array<wire::wire_word_t, {}> message{{ {} }}", size / sizeof(wire_word_t), words)));
+            body.push_back(shared_expr(send_message("message.data()", "sizeof(message)")));
+            return body;
+        }
+
+        // String is prefixed by length word and padded to words with terminating zero, array is padded to words.
+        std::string reserve = std::to_string(size);
+        for (const auto& arg : request.arguments) {
+            if (arg.type == wire_type::STRING) {
+                reserve += std::format(" + (({}.size() + 4) & ~std::size_t(3))", arg.name);
+            } else if (arg.type == wire_type::ARRAY) {
+                reserve += std::format(" + (({}.size() + 3) & ~std::size_t(3))", arg.name);
+            }
+        }
+
+        body.push_back(shared_expr(std::format("wire::WireObjectBuilder builder(id_, {})", op_code_name(request.name))));
+        // Interface name of untyped new_id is known only to WireObjectBuilder, there is no exact size to reserve.
+        if (std::ranges::none_of(request.arguments, is_untyped_new_id)) {
+            body.push_back(shared_expr(std::format("builder.reserve({})", reserve)));
+        }
+        auto names = added_arguments(request);
+        if (!names.empty()) {
+            body.push_back(shared_expr(std::format("builder.add({})", names)));
+        }
+        for (const auto& statement : gen_queue_fds(request)) {
+            body.push_back(statement);
+        }
+        body.push_back(shared_expr(send_message("builder.data()", "builder.size()")));
+
+        return body;
+    }
+
+    std::string Builder::send_message(std::string_view data, std::string_view size) const {
+        return std::format("sock.{}({}, {})", options.corked ? "queue" : "write", data, size);
+    }
+
+    std::vector<Builder::SupportHeader> Builder::support_headers() const {
+        std::vector<SupportHeader> headers;
+        SupportHeader metadata{ std::filesystem::path("include") / "waylandcpp" / "wire" / "metadata.hpp", {} };
+        metadata.text << std::string(metadata_source());
+        headers.push_back(std::move(metadata));
+        if (options.fd_queue) {
+            SupportHeader ring{ std::filesystem::path("include") / "waylandcpp" / "wire" / "fd_ring.hpp", {} };
+            ring.text << std::string(fd_ring_source());
+            headers.push_back(std::move(ring));
+        }
+        if (options.corked) {
+            SupportHeader outgoing{ std::filesystem::path("include") / "waylandcpp" / "wire" / "outgoing_buffer.hpp", {} };
+            outgoing.text << std::string(outgoing_buffer_source());
+            headers.push_back(std::move(outgoing));
+        }
+        return headers;
+    }
+
+    cpp::parameter_list_t Builder::gen_parameters(const std::vector<WLArgument>& args, bool event) {
         cpp::parameter_list_t params;
 
         for (const auto& arg : args) {
-            cpp::decl_specifier_seq_t ds(wire_to_type(arg.type));
-            cpp::init_declarator_t indecl(cpp::unqid_t(arg.name));
+            cpp::decl_specifier_seq_t ds(event ? event_arg_type(arg.type) : wire_to_type(arg.type));
+            cpp::init_declarator_t indecl(cpp::unqid_t(std::string(arg.name)));
             // NOTE: I am doing basic implementation here so I am not going to use enums in case there were enums specified in xml, but I am going to do it latter to have links between types in events and enums.
             params.emplace_back(ds, indecl);
         }
@@ -178,9 +440,9 @@ namespace wayland::generator {
         for (const auto& req : requests) {
             cpp::decl_specifier_seq_t ds(void_type);
             auto req_params = gen_parameters(req.arguments);
-            auto name = req.name;
+            auto name = std::string(req.name);
             cpp::function_declaration_t req_decl(cpp::unqid_t(name), req_params);
-            auto body = cpp::function_body_t(gen_request_body(req_decl));
+            auto body = cpp::function_body_t(options.static_marshal ? gen_static_request_body(req) : gen_request_body(req));
             cpp::function_t function(ds, req_decl, body);
             methods.push_back(function);
         }
@@ -192,13 +454,13 @@ namespace wayland::generator {
         std::vector<cpp::enum_specifier_t> es;
 
         for (const auto& e : enums) {
-            cpp::enum_specifier_t em(e.name + "_e", uint32_type);
+            cpp::enum_specifier_t em(std::format("{}_e", e.name), uint32_type);
             for (const auto& entry : e.entries) {
-                auto name = entry.name;
+                auto name = std::string(entry.name);
                 if (std::isdigit(name[0]) || name == "default") {
                     name = "_" + name;
                 }
-                auto value = entry.value;
+                auto value = std::string(entry.value);
                 em.add(cpp::enum_specifier_t::entity_t(name, value));
             }
             es.push_back(em);
@@ -211,10 +473,30 @@ namespace wayland::generator {
         std::vector<cpp::function_t> methods;
 
         for (const auto& event : events) {
-            cpp::decl_specifier_seq_t ds({ cpp::virtual_qualifier, void_type });
-            auto event_params = gen_parameters(event.arguments);
-            auto name = event.name;
+            auto event_params = gen_parameters(event.arguments, true);
+            auto name = std::string(event.name);
             cpp::function_declaration_t event_decl(cpp::unqid_t(name), event_params);
+            // Default handling of the event, Handler hides it with its own method of the same name.
+            if (options.crtp) {
+                methods.emplace_back(cpp::decl_specifier_seq_t(void_type), event_decl, cpp::compound_statement_t());
+                continue;
+            }
+
+            // Entry of shared handlers table gets user data of the object.
+            if (options.compact) {
+                std::string call = std::format("handlers->{}(data", event.name);
+                for (const auto& arg : event.arguments) {
+                    call += std::format(", {}", arg.name);
+                }
+                call += ")";
+                cpp::statement_ptr call_handler = cpp::make_node<cpp::expression_statement_t>(call);
+                cpp::compound_statement_t body;
+                body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t(std::format("handlers->{}", event.name)), call_handler));
+                methods.emplace_back(cpp::decl_specifier_seq_t(void_type), event_decl, body);
+                continue;
+            }
+
+            cpp::decl_specifier_seq_t ds({ cpp::virtual_qualifier, void_type });
             cpp::compound_statement_t body;
             {
                 auto callback_name = alias_name(event.name);
@@ -228,8 +510,8 @@ namespace wayland::generator {
                     }
                 }
                 call_ss << ")";
-                cpp::statement_ptr call_callback = std::make_shared<cpp::expression_statement_t>(call_ss.str());
-                body.push_back(std::make_shared<cpp::if_statement_t>(cpp::condition_t(callback_name), call_callback));
+                cpp::statement_ptr call_callback = cpp::make_node<cpp::expression_statement_t>(call_ss.str());
+                body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t(callback_name), call_callback));
             }
             methods.emplace_back(ds, event_decl, body);
         }
@@ -256,6 +538,20 @@ namespace wayland::generator {
             sds.emplace_back(decl_spec, init_decl);
         }
 
+        if (options.static_marshal) {
+            // Second word of fixed size request: size in upper 16 bits, opcode in lower.
+            static cpp::qid_t word_type(ns, cpp::unqid_t("wire_word_t"));
+            for (const auto& req : interface.requests) {
+                if (!is_fixed_size(req.arguments)) {
+                    continue;
+                }
+                cpp::decl_specifier_seq_t decl_spec(cpp::static_specifier, cpp::constexpr_specifier, word_type);
+                auto value = std::format("({:#x} << 16) | {}", static_wire_size(req.arguments), op_code_name(req.name));
+                cpp::init_declarator_list_t init_decl({cpp::unqid_t(header_name(req.name)), value});
+                sds.emplace_back(decl_spec, init_decl);
+            }
+        }
+
         counter = 0;
         for (const auto& ev : interface.events) {
             cpp::decl_specifier_seq_t decl_spec(cpp::static_specifier, cpp::constexpr_specifier, op_code_type);
@@ -266,28 +562,84 @@ namespace wayland::generator {
         add_field(socket_type, cpp::lval_t(cpp::unqid_t("sock")));
         add_field(wire_to_type(wire_type::OBJECT), cpp::unqid_t("id_"));
 
+        // Object keeps only pointer to handlers table shared by all objects with the same handlers.
+        if (options.compact) {
+            static cpp::simple_type_specifier_t handlers_type("handlers_t");
+            cpp::decl_specifier_seq_t no_handlers_spec(cpp::static_specifier, cpp::constexpr_specifier, handlers_type);
+            sds.emplace_back(no_handlers_spec, cpp::init_declarator_list_t({cpp::unqid_t("no_handlers"), std::string("{}")}));
+            static cpp::simple_type_specifier_t handlers_ptr_type("const handlers_t *");
+            add_field(handlers_ptr_type, cpp::init_declarator_list_t({cpp::unqid_t("handlers"), std::string("&no_handlers")}));
+            static cpp::simple_type_specifier_t data_type("void *");
+            add_field(data_type, cpp::init_declarator_list_t({cpp::unqid_t("data"), std::string("nullptr")}));
+            return sds;
+        }
+
         if (!is_essential(interface.name)) {
             add_field(wire_to_type(wire_type::UINT), cpp::unqid_t("name_"));
         }
 
-        for (const auto& ev : interface.events) {
-            add_field(cpp::unqid_t(alias_type(ev.name)), cpp::unqid_t(alias_name(ev.name)));
+        if (!options.crtp) {
+            for (const auto& ev : interface.events) {
+                add_field(cpp::unqid_t(alias_type(ev.name)), cpp::unqid_t(alias_name(ev.name)));
+            }
         }
 
         return sds;
     }
 
+    // Signature in libwayland format: since version if above 1, then a type code per argument,
+    // prefixed by '?' when null is allowed. new_id without interface is sent as interface name, version and id.
+    std::string message_signature(const WLAction& action) {
+        std::string signature = action.since > 1 ? std::to_string(action.since) : std::string();
+        for (const auto& arg : action.arguments) {
+            if (arg.allow_null) {
+                signature += '?';
+            }
+            switch (arg.type) {
+            case wire_type::INT:    signature += 'i'; break;
+            case wire_type::UINT:   signature += 'u'; break;
+            case wire_type::FIXED:  signature += 'f'; break;
+            case wire_type::STRING: signature += 's'; break;
+            case wire_type::OBJECT: signature += 'o'; break;
+            case wire_type::NEW_ID: signature += arg.arg_interface ? "n" : "sun"; break;
+            case wire_type::ARRAY:  signature += 'a'; break;
+            case wire_type::FD:     signature += 'h'; break;
+            }
+        }
+        return signature;
+    }
+
+    template<typename Action>
+    static cpp::simple_declaration_t gen_message_metadata(std::string_view name, const std::vector<Action>& actions) {
+        cpp::simple_type_specifier_t array_type(std::format("std::array<wire::MessageMetadata, {}>", actions.size()));
+        cpp::decl_specifier_seq_t ds(cpp::static_specifier, cpp::constexpr_specifier, array_type);
+        std::string messages;
+        for (const auto& action : actions) {
+            messages += std::format("{}{{ \"{}\", \"{}\" }}", messages.empty() ? "" : ", ", action.name, message_signature(action));
+        }
+        std::string value = messages.empty() ? "{}" : std::format("{{{{ {} }}}}", messages);
+        return cpp::simple_declaration_t(ds, cpp::init_declarator_list_t({cpp::unqid_t(std::string(name)), value}));
+    }
+
     std::vector<cpp::simple_declaration_t> Builder::gen_public_const(const WLInterface& interface) {
         std::vector<cpp::simple_declaration_t> sds;
-        {
-            cpp::decl_specifier_seq_t interface_name_ds(cpp::const_qualifier, string_type);
-            cpp::init_declarator_list_t interface_ini_decl({cpp::unqid_t("interface"), std::format("\"{}\"", interface.name)});
-            sds.emplace_back(interface_name_ds, interface_ini_decl);
-        }
+        static cpp::simple_type_specifier_t string_view_type("std::string_view");
+        static cpp::simple_type_specifier_t int_type("int");
+
+        cpp::decl_specifier_seq_t interface_name_ds(cpp::static_specifier, cpp::constexpr_specifier, string_view_type);
+        cpp::init_declarator_list_t interface_ini_decl({cpp::unqid_t("interface"), std::format("\"{}\"", interface.name)});
+        sds.emplace_back(interface_name_ds, interface_ini_decl);
+
+        cpp::decl_specifier_seq_t version_ds(cpp::static_specifier, cpp::constexpr_specifier, int_type);
+        cpp::init_declarator_list_t version_ini_decl({cpp::unqid_t("version"), std::to_string(interface.version)});
+        sds.emplace_back(version_ds, version_ini_decl);
+
+        sds.push_back(gen_message_metadata("request_metadata", interface.requests));
+        sds.push_back(gen_message_metadata("event_metadata", interface.events));
         return sds;
     }
 
-    cpp::function_t Builder::gen_dispatcher(const std::vector<WLEvent>& events) {
+    cpp::function_t Builder::gen_dispatcher(const WLInterface& interface) {
         cpp::decl_specifier_seq_t ds(void_type);
 
         cpp::parameter_list_t params;
@@ -302,48 +654,17 @@ namespace wayland::generator {
             cpp::decl_specifier_seq_t body_type(wbp);
             cpp::init_declarator_t    body(cpp::lval_t(cpp::unqid_t("body")));
             params.emplace_back(body_type, body);
+            add_fd_ring_parameter(params, std::ranges::any_of(interface.events, [&](const WLEvent& event) { return pops_fds(options, event.arguments); }));
         }
         cpp::function_declaration_t req_decl(cpp::unqid_t("dispatch"), params);
 
-        auto switch_body = std::make_shared<cpp::compound_statement_t>();
-        for (auto& event : events) {
-            switch_body->push_back(std::make_shared<cpp::label_statement_t>(cpp::label_statement_t::label_t::CASE, op_code_name(event.name)));
-            auto case_body = std::make_shared<cpp::compound_statement_t>();
-
-            std::stringstream auto_;
-            std::stringstream parse;
-            std::stringstream call;
-            call << event.name << "(";
-            if (event.arguments.size() > 0) {
-                auto_ << "auto [";
-                parse << "body.parse<";
-                auto it = event.arguments.begin();
-                auto add_new = [&](auto arg) {
-                    // Doing it like this for now because enum, function and parameters can have same name in xml.
-                    auto value_name = arg.name + "_v";
-                    auto_ << value_name;
-                    auto type = std::get<cpp::qid_t>(wire_to_type(arg.type));
-                    parse << ns_prefix.id() << "::" << type.id().id();
-                    call << value_name;
-                };
-                add_new(*it);
-
-                while (++it != event.arguments.end()) {
-                    auto_ << ",";
-                    parse << ",";
-                    call  << ",";
-                    add_new(*it);
-                }
-                parse << ">()";
-                auto_ << "] = " << parse.str();
-                case_body->push_back(std::make_shared<cpp::expression_statement_t>(auto_.str()));
-            }
-            call << ")";
-            case_body->push_back(std::make_shared<cpp::expression_statement_t>(call.str()));
-            switch_body->push_back(case_body);
-            switch_body->push_back(std::make_shared<cpp::jump_statement_t>(cpp::jump_statement_t::jump_t::BREAK));
+        auto switch_body = cpp::make_node<cpp::compound_statement_t>();
+        for (auto& event : interface.events) {
+            switch_body->push_back(cpp::make_node<cpp::label_statement_t>(cpp::label_statement_t::label_t::CASE, op_code_name(event.name)));
+            switch_body->push_back(cpp::make_node<cpp::compound_statement_t>(gen_event_decode(interface, event, options.crtp ? "handler()." : "", "")));
+            switch_body->push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::jump_t::BREAK));
         }
-        auto dispatch_switch = std::make_shared<cpp::switch_statement_t>(cpp::expression_t("op"), switch_body);
+        auto dispatch_switch = cpp::make_node<cpp::switch_statement_t>(cpp::expression_t("op"), switch_body);
 
         cpp::compound_statement_t function_body;
         function_body.push_back(dispatch_switch);
@@ -353,11 +674,347 @@ namespace wayland::generator {
         return dispatch_f;
     }
 
+    cpp::compound_statement_t Builder::gen_event_decode(const WLInterface& interface, const WLEvent& event, std::string_view receiver, std::string_view self) {
+        cpp::compound_statement_t decode;
+
+        std::stringstream auto_;
+        std::stringstream parse;
+        std::stringstream call;
+        if (find_coalesce(interface, event.name)) {
+            call << self << coalesce_name(event.name) << "(";
+        } else {
+            // Pending events happened before this one, so they are delivered first.
+            if (has_coalesce(options.coalesce, interface.name)) {
+                decode.push_back(cpp::make_node<cpp::expression_statement_t>(std::format("{}flush_coalesced()", self)));
+            }
+            call << receiver << event.name << "(";
+        }
+        // Queued fds are not in the body, they are taken from the ring in order of arguments.
+        std::vector<std::string> popped;
+        bool parsed = false;
+        for (const auto& arg : event.arguments) {
+            // Doing it like this for now because enum, function and parameters can have same name in xml.
+            auto value_name = std::format("{}_v", arg.name);
+            call << (&arg == &event.arguments.front() ? "" : ",") << value_name;
+            if (options.fd_queue && arg.type == wire_type::FD) {
+                popped.push_back(std::format("auto {} = fds.pop()", value_name));
+                continue;
+            }
+            auto_ << (parsed ? "," : "auto [") << value_name;
+            parse << (parsed ? "," : "body.parse<") << event_arg_type_name(arg.type);
+            parsed = true;
+        }
+        if (parsed) {
+            parse << ">()";
+            auto_ << "] = " << parse.str();
+            decode.push_back(cpp::make_node<cpp::expression_statement_t>(auto_.str()));
+        }
+        for (const auto& pop : popped) {
+            decode.push_back(cpp::make_node<cpp::expression_statement_t>(pop));
+        }
+        call << ")";
+        decode.push_back(cpp::make_node<cpp::expression_statement_t>(call.str()));
+
+        return decode;
+    }
+
+    std::vector<cpp::function_t> Builder::gen_table_dispatcher() {
+        std::vector<cpp::function_t> functions;
+
+        auto ns = cpp::unqid_t(ns_prefix);
+        static cpp::qid_t op_code_type(ns, cpp::unqid_t("wire_op_t"));
+        auto wbp = cpp::unqid_t("wire::WireBufferParser");
+
+        cpp::parameter_list_t params;
+        params.emplace_back(cpp::decl_specifier_seq_t(op_code_type), cpp::init_declarator_t(cpp::unqid_t("op")));
+        params.emplace_back(cpp::decl_specifier_seq_t(wbp), cpp::init_declarator_t(cpp::lval_t(cpp::unqid_t("body"))));
+        add_fd_ring_parameter(params, true);
+
+        // One bounds check, then jump through the table.
+        cpp::compound_statement_t dispatch_body;
+        auto unknown = cpp::make_node<cpp::compound_statement_t>();
+        unknown->push_back(cpp::make_node<cpp::expression_statement_t>(options.crtp ? "handler().unknown_opcode(op)" : "unknown_opcode(op)"));
+        unknown->push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::jump_t::RETURN));
+        dispatch_body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t("op >= decoders.size()"), unknown));
+        dispatch_body.push_back(cpp::make_node<cpp::expression_statement_t>(options.fd_queue ? "decoders[op](*this, body, fds)" : "decoders[op](*this, body)"));
+        functions.emplace_back(cpp::decl_specifier_seq_t(void_type),
+                               cpp::function_declaration_t(cpp::unqid_t("dispatch"), params),
+                               cpp::function_body_t(dispatch_body));
+
+        // Opcode outside of interface is protocol error, connection is expected to override it.
+        cpp::parameter_list_t unknown_params;
+        unknown_params.emplace_back(cpp::decl_specifier_seq_t(op_code_type), cpp::init_declarator_t(parameter_name("op", options.compact)));
+        auto unknown_ds = options.crtp || options.compact ? cpp::decl_specifier_seq_t(void_type) : cpp::decl_specifier_seq_t({ cpp::virtual_qualifier, void_type });
+        cpp::compound_statement_t unknown_body;
+        if (options.compact) {
+            auto report = cpp::make_node<cpp::expression_statement_t>("handlers->unknown_opcode(data, op)");
+            unknown_body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t("handlers->unknown_opcode"), report));
+        }
+        functions.emplace_back(unknown_ds,
+                               cpp::function_declaration_t(cpp::unqid_t("unknown_opcode"), unknown_params),
+                               cpp::function_body_t(unknown_body));
+
+        return functions;
+    }
+
+    cpp::clas Builder::gen_handlers(const WLInterface& interface) {
+        cpp::clas handlers(handlers_name(interface.name), cpp::class_key_t::STRUCT);
+
+        std::vector<std::string> entries;
+        for (const auto& event : interface.events) {
+            std::string signature = "void *";
+            for (const auto& arg : event.arguments) {
+                signature += std::format(", {}", event_arg_type_name(arg.type));
+            }
+            handlers.append(cpp::type_alias_t(std::format("{}_t", event.name), std::format("void (*)({})", signature)));
+            entries.emplace_back(event.name);
+        }
+        if (options.table_dispatch) {
+            handlers.append(cpp::type_alias_t("unknown_opcode_t", "void (*)(void *, wire::wire_op_t)"));
+            entries.emplace_back("unknown_opcode");
+        }
+
+        // Empty entries are skipped, so designated initializers can set only needed ones.
+        for (const auto& entry : entries) {
+            cpp::decl_specifier_seq_t ds(cpp::simple_type_specifier_t(std::format("{}_t", entry)));
+            handlers.append(cpp::member_object_t(ds, cpp::init_declarator_list_t({cpp::unqid_t(entry), std::string("nullptr")})));
+        }
+
+        return handlers;
+    }
+
+    std::size_t Builder::estimate_size(const WLInterface& interface) const {
+        // LP64 with libstdc++: std::function is 32 bytes.
+        constexpr std::size_t pointer = 8, word = 4, function = 32;
+        std::size_t size = 0;
+        auto add = [&](std::size_t member, std::size_t align) {
+            size = (size + align - 1) / align * align + member;
+        };
+
+        bool virtuals = !options.crtp && !options.compact && (!interface.events.empty() || options.table_dispatch);
+        if (virtuals) {
+            add(pointer, pointer);
+        }
+        add(pointer, pointer);
+        add(word, word);
+        if (options.compact) {
+            add(pointer, pointer);
+            add(pointer, pointer);
+        } else {
+            if (!is_essential(interface.name)) {
+                add(word, word);
+            }
+            if (!options.crtp) {
+                for (std::size_t i = 0; i < interface.events.size(); ++i) {
+                    add(function, pointer);
+                }
+            }
+        }
+        // Every coalescable argument is one word: std::optional of tuple, or std::vector with key.
+        for (const auto& event : interface.events) {
+            if (auto coalesce = find_coalesce(interface, event.name)) {
+                if (coalesce->key) {
+                    add(3 * pointer, pointer);
+                } else {
+                    add((event.arguments.size() + 1) * word, word);
+                }
+            }
+        }
+        return (size + pointer - 1) / pointer * pointer;
+    }
+
+    const Builder::Options::Coalesce* Builder::find_coalesce(const WLInterface& interface, std::string_view event) const {
+        auto found = std::ranges::find_if(options.coalesce, [&](const Options::Coalesce& entry) {
+            return entry.interface == interface.name && entry.event == event;
+        });
+        return found != options.coalesce.end() ? &*found : nullptr;
+    }
+
+    void Builder::validate(const WLInterface& interface) const {
+        for (const auto& entry : options.coalesce) {
+            if (entry.interface != interface.name) {
+                continue;
+            }
+            auto name = std::format("{}.{}", entry.interface, entry.event);
+            auto event = std::ranges::find(interface.events, entry.event, &WLEvent::name);
+            if (event == interface.events.end()) {
+                throw std::runtime_error(std::format("Coalesced event '{}' doesn't exist!", name));
+            }
+            if (std::ranges::find(interface.events, "frame", &WLEvent::name) == interface.events.end()) {
+                throw std::runtime_error(std::format("Interface '{}' has no frame event to deliver coalesced '{}' at!", entry.interface, name));
+            }
+            if (entry.event == "frame") {
+                throw std::runtime_error(std::format("Frame event '{}' can't be coalesced!", name));
+            }
+            for (const auto& arg : event->arguments) {
+                if (!is_coalescable(arg.type)) {
+                    throw std::runtime_error(std::format("Event '{}' has argument '{}' which can't be kept until frame!", name, arg.name));
+                }
+            }
+            if (entry.key && std::ranges::find(event->arguments, *entry.key, &WLArgument::name) == event->arguments.end()) {
+                throw std::runtime_error(std::format("Event '{}' has no key argument '{}'!", name, *entry.key));
+            }
+            if (entry.mode == Options::Coalesce::mode_t::SUM && std::ranges::none_of(event->arguments, [&](const WLArgument& arg) {
+                    return (arg.type == wire_type::INT || arg.type == wire_type::FIXED) && arg.name != entry.key;
+                })) {
+                throw std::runtime_error(std::format("Event '{}' has no int or fixed argument to sum!", name));
+            }
+        }
+    }
+
+    std::vector<cpp::simple_declaration_t> Builder::gen_coalesce_variables(const WLInterface& interface) {
+        std::vector<cpp::simple_declaration_t> sds;
+        for (const auto& event : interface.events) {
+            auto coalesce = find_coalesce(interface, event.name);
+            if (!coalesce) {
+                continue;
+            }
+            std::string tuple;
+            for (const auto& type : get_types_list(event.arguments)) {
+                tuple += tuple.empty() ? type : std::format(", {}", type);
+            }
+            // Keyed events keep one entry per key in order of arrival, vector keeps its capacity between frames.
+            auto type = coalesce->key ? std::format("std::vector<std::tuple<{}>>", tuple) : std::format("std::optional<std::tuple<{}>>", tuple);
+            sds.emplace_back(cpp::decl_specifier_seq_t(cpp::simple_type_specifier_t(type)), cpp::init_declarator_list_t(cpp::unqid_t(pending_name(event.name))));
+        }
+        return sds;
+    }
+
+    std::vector<cpp::function_t> Builder::gen_coalesce_methods(const WLInterface& interface) {
+        std::vector<cpp::function_t> methods;
+        auto shared_expr = [](const std::string& s) { return cpp::make_node<cpp::expression_statement_t>(s); };
+        for (const auto& event : interface.events) {
+            auto coalesce = find_coalesce(interface, event.name);
+            if (!coalesce) {
+                continue;
+            }
+            auto pending = pending_name(event.name);
+            std::string values;
+            for (const auto& arg : event.arguments) {
+                values += values.empty() ? std::string(arg.name) : std::format(", {}", arg.name);
+            }
+            // Statements merging the event into pending tuple.
+            auto merge = [&](std::string_view tuple) {
+                auto merged = cpp::make_node<cpp::compound_statement_t>();
+                for (std::size_t i = 0; i < event.arguments.size(); ++i) {
+                    const auto& arg = event.arguments[i];
+                    if (arg.name == coalesce->key) {
+                        continue;
+                    }
+                    bool sum = coalesce->mode == Options::Coalesce::mode_t::SUM && (arg.type == wire_type::INT || arg.type == wire_type::FIXED);
+                    merged->push_back(shared_expr(std::format("std::get<{}>({}) {} {}", i, tuple, sum ? "+=" : "=", arg.name)));
+                }
+                return merged;
+            };
+
+            cpp::compound_statement_t body;
+            if (coalesce->key) {
+                auto key = std::ranges::find(event.arguments, *coalesce->key, &WLArgument::name) - event.arguments.begin();
+                auto found = merge("entry");
+                found->push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::jump_t::RETURN));
+                auto search = cpp::make_node<cpp::compound_statement_t>();
+                search->push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t(std::format("std::get<{}>(entry) == {}", key, *coalesce->key)), found));
+                body.push_back(cpp::make_node<cpp::range_for_statement_t>(cpp::expression_t(std::format("auto & entry : {}", pending)), search));
+                body.push_back(shared_expr(std::format("{}.emplace_back({})", pending, values)));
+            } else if (coalesce->mode == Options::Coalesce::mode_t::LATEST) {
+                body.push_back(shared_expr(std::format("{}.emplace({})", pending, values)));
+            } else {
+                auto first = cpp::make_node<cpp::compound_statement_t>();
+                first->push_back(shared_expr(std::format("{}.emplace({})", pending, values)));
+                first->push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::jump_t::RETURN));
+                body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t(std::format("!{}", pending)), first));
+                // Kept in a local, compound statement has to outlive the loop over it.
+                auto merged = merge(std::format("*{}", pending));
+                for (const auto& statement : *merged) {
+                    body.push_back(statement);
+                }
+            }
+            methods.emplace_back(cpp::decl_specifier_seq_t(void_type),
+                                 cpp::function_declaration_t(cpp::unqid_t(coalesce_name(event.name)), gen_parameters(event.arguments, true)),
+                                 cpp::function_body_t(body));
+        }
+        return methods;
+    }
+
+    std::vector<cpp::function_t> Builder::gen_flush_coalesced(const WLInterface& interface) {
+        std::vector<cpp::function_t> functions;
+        if (!has_coalesce(options.coalesce, interface.name)) {
+            return functions;
+        }
+
+        // Delivers pending events, called before every other event and available to the connection,
+        // e.g. when compositor doesn't send frame for the bound version.
+        cpp::compound_statement_t body;
+        for (const auto& event : interface.events) {
+            auto coalesce = find_coalesce(interface, event.name);
+            if (!coalesce) {
+                continue;
+            }
+            auto pending = pending_name(event.name);
+            auto deliver = std::format("std::apply([this](auto... args) {{ {}{}(args...); }}, {})",
+                                       options.crtp ? "handler()." : "", event.name, coalesce->key ? "entry" : "*pending");
+            if (coalesce->key) {
+                body.push_back(cpp::make_node<cpp::range_for_statement_t>(cpp::expression_t(std::format("const auto & entry : {}", pending)),
+                                                                          cpp::make_node<cpp::expression_statement_t>(deliver)));
+                body.push_back(cpp::make_node<cpp::expression_statement_t>(std::format("{}.clear()", pending)));
+            } else {
+                body.push_back(cpp::make_node<cpp::if_statement_t>(cpp::condition_t(std::format("auto pending = std::exchange({}, std::nullopt)", pending)),
+                                                                   cpp::make_node<cpp::expression_statement_t>(deliver)));
+            }
+        }
+        functions.emplace_back(cpp::decl_specifier_seq_t(void_type),
+                               cpp::function_declaration_t(cpp::unqid_t("flush_coalesced"), cpp::parameter_list_t()),
+                               cpp::function_body_t(body));
+        return functions;
+    }
+
+    cpp::function_t Builder::gen_handler_accessor() {
+        cpp::decl_specifier_seq_t ds(cpp::simple_type_specifier_t("Handler &"));
+        cpp::function_declaration_t decl(cpp::unqid_t("handler"), cpp::parameter_list_t());
+        cpp::compound_statement_t body;
+        body.push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::return_statement(cpp::expression_t("static_cast<Handler &>(*this)"))));
+        return cpp::function_t(ds, decl, cpp::function_body_t(body));
+    }
+
+    void Builder::add_fd_ring_parameter(cpp::parameter_list_t& params, bool used) {
+        if (options.fd_queue) {
+            params.emplace_back(cpp::decl_specifier_seq_t(cpp::unqid_t("wire::FdRing")), cpp::init_declarator_t(cpp::lval_t(parameter_name("fds", used))));
+        }
+    }
+
+    std::vector<cpp::function_t> Builder::gen_decoders(const WLInterface& interface) {
+        std::vector<cpp::function_t> decoders;
+        auto wbp = cpp::unqid_t("wire::WireBufferParser");
+        auto self_type = cpp::unqid_t(std::string(interface.name));
+
+        for (const auto& event : interface.events) {
+            cpp::parameter_list_t params;
+            params.emplace_back(cpp::decl_specifier_seq_t(self_type), cpp::init_declarator_t(cpp::lval_t(cpp::unqid_t("self"))));
+            params.emplace_back(cpp::decl_specifier_seq_t(wbp), cpp::init_declarator_t(cpp::lval_t(parameter_name("body", parses_body(options, event.arguments)))));
+            add_fd_ring_parameter(params, pops_fds(options, event.arguments));
+            decoders.emplace_back(cpp::decl_specifier_seq_t({ cpp::static_specifier, void_type }),
+                                  cpp::function_declaration_t(cpp::unqid_t(decoder_name(event.name)), params),
+                                  cpp::function_body_t(gen_event_decode(interface, event, options.crtp ? "self.handler()." : "self.", "self.")));
+        }
+
+        return decoders;
+    }
+
+    cpp::simple_declaration_t Builder::gen_decoder_table(const WLInterface& interface) {
+        std::string decoders;
+        for (const auto& event : interface.events) {
+            decoders += std::format("{}&{}", decoders.empty() ? " " : ", ", decoder_name(event.name));
+        }
+        auto table_type = cpp::simple_type_specifier_t(std::format("std::array<decoder_t, {}>", interface.events.size()));
+        cpp::decl_specifier_seq_t decl_spec(cpp::static_specifier, cpp::constexpr_specifier, table_type);
+        cpp::init_declarator_list_t init_decl({cpp::unqid_t("decoders"), std::format("{{{} }}", decoders)});
+        return cpp::simple_declaration_t(decl_spec, init_decl);
+    }
+
     std::vector<std::string> Builder::get_types_list(const std::vector<WLArgument>& arguments) {
         std::vector<std::string> types;
         for (auto arg : arguments) {
-            auto type = std::get<cpp::qid_t>(wire_to_type(arg.type));
-            types.emplace_back(std::format("{}::{}", ns_prefix.id(), type.id().id()));
+            types.emplace_back(event_arg_type_name(arg.type));
         }
         return types;
     }
@@ -389,11 +1046,34 @@ namespace wayland::generator {
         cpp::function_declaration_t req_decl(cpp::unqid_t("id"), params);
 
         cpp::compound_statement_t id_body;
-        id_body.push_back(std::make_shared<cpp::jump_statement_t>(cpp::jump_statement_t::return_statement(cpp::expression_t("id_"))));
+        id_body.push_back(cpp::make_node<cpp::jump_statement_t>(cpp::jump_statement_t::return_statement(cpp::expression_t("id_"))));
         auto body = cpp::function_body_t(id_body);
 
         utility.emplace_back(ds, req_decl, body);
 
+        if (options.compact) {
+            static cpp::simple_type_specifier_t handlers_ptr_type("const handlers_t *");
+            static cpp::simple_type_specifier_t data_type("void *");
+            cpp::parameter_list_t params;
+            params.emplace_back(cpp::decl_specifier_seq_t(handlers_ptr_type), cpp::init_declarator_t(cpp::unqid_t("handlers_")));
+            params.emplace_back(cpp::decl_specifier_seq_t(data_type), cpp::init_declarator_t(cpp::unqid_t("data_"), cpp::copy_initialization_t("nullptr")));
+            cpp::compound_statement_t set_body;
+            set_body.push_back(cpp::make_node<cpp::expression_statement_t>("handlers = handlers_ ? handlers_ : &no_handlers"));
+            set_body.push_back(cpp::make_node<cpp::expression_statement_t>("data = data_"));
+            utility.emplace_back(cpp::decl_specifier_seq_t(void_type),
+                                 cpp::function_declaration_t(cpp::unqid_t("set_handlers"), params),
+                                 cpp::function_body_t(set_body));
+        }
+
+        // Explicit flush point of corked requests, like wl_display_flush.
+        if (options.corked && interface.name == "wl_display") {
+            cpp::decl_specifier_seq_t flush_ds(void_type);
+            cpp::function_declaration_t flush_decl(cpp::unqid_t("flush"), cpp::parameter_list_t());
+            cpp::compound_statement_t flush_body;
+            flush_body.push_back(cpp::make_node<cpp::expression_statement_t>("sock.flush()"));
+            utility.emplace_back(flush_ds, flush_decl, cpp::function_body_t(flush_body));
+        }
+
         return utility;
     }
 
@@ -412,18 +1092,19 @@ namespace wayland::generator {
             ctor_init.elements().emplace_back(m, m.id());
         }
 
-        if (!is_essential(interface.name)) {
+        if (!is_essential(interface.name) && !options.compact) {
             auto name = cpp::unqid_t("name_");
             ctr_params.emplace_back(wire_to_type(wire_type::UINT), cpp::init_declarator_t(cpp::rval_t(name), cpp::copy_initialization_t("0x0")));
             ctor_init.elements().emplace_back(name, name.id());
         }
 
         cpp::function_body_t ctr_body({}, ctor_init);
-        auto ctr_decl = cpp::function_declaration_t(cpp::unqid_t(interface.name), ctr_params);
+        auto ctr_decl = cpp::function_declaration_t(cpp::unqid_t(std::string(interface.name)), ctr_params);
         ctrs.emplace_back(ctr_decl, ctr_body);
 
 
-        if (interface.events.size() == 0) {
+        // Handler or handlers table receives events instead of callbacks.
+        if (interface.events.size() == 0 || options.crtp || options.compact) {
             return ctrs;
         }
 
@@ -443,7 +1124,7 @@ namespace wayland::generator {
         }
 
         cpp::function_body_t ctr2_body({}, ctor_init);
-        ctr_decl = cpp::function_declaration_t(cpp::unqid_t(interface.name), ctr2_params);
+        ctr_decl = cpp::function_declaration_t(cpp::unqid_t(std::string(interface.name)), ctr2_params);
         ctrs.emplace_back(ctr_decl, ctr2_body);
 
         return ctrs;
@@ -1,28 +1,103 @@
 #pragma once
 
 #include "protocol.hpp"
+#include "stats.hpp"
 #include "cpp/declaration/includes.hpp"
 #include "cpp/declaration/function.hpp"
 #include "cpp/declaration/class.hpp"
 #include "cpp/transform/text.hpp"
 #include "cpp/declaration/enum.hpp"
 #include "cpp/declaration/type_alias.hpp"
+#include "cpp/declaration/namespace.hpp"
+#include "cpp/arena.hpp"
 
 namespace wayland::generator {
+    // Naming shared by AST and direct backends.
+    // wl_display and wl_registry objects are not created from registry, they don't keep name_.
+    bool is_essential(std::string_view interface);
+    std::string op_code_name(std::string_view orig);
+    std::string alias_type(std::string_view name);
+    std::string alias_name(std::string_view name);
+    // Signature in libwayland format, see wire::MessageMetadata.
+    std::string message_signature(const WLAction& action);
+
     class Builder {
     public:
+        struct Options {
+            // Allocate AST statements of each interface in one arena released after formatting.
+            bool arena = false;
+            // Wire size of requests is computed at generation time: fixed size requests are encoded
+            // into std::array on stack, others reserve exact size in WireObjectBuilder once.
+            bool static_marshal = false;
+            // Requests are queued with sock.queue instead of sock.write and sent on flush,
+            // see OutgoingBuffer in support headers.
+            bool corked = false;
+            // Events are dispatched through static constexpr table of decoders indexed by opcode,
+            // unknown opcode is reported to virtual unknown_opcode.
+            bool table_dispatch = false;
+            // Interfaces are CRTP bases template<typename Handler>, events are delivered to Handler
+            // statically instead of virtual methods and callbacks.
+            bool crtp = false;
+            // String and array event arguments are std::string_view and std::span<const std::byte>
+            // into the receive buffer, valid until the event returns.
+            bool view_args = false;
+            // Object keeps socket, id and pointer to handlers table <interface>_handlers shared between objects
+            // plus user data pointer, instead of callback per event and name.
+            bool compact = false;
+            // Requires corked. Fds of requests are queued with sock.queue_fd and sent as SCM_RIGHTS with the next batch,
+            // fds of events are popped from wire::FdRing passed to dispatch instead of parsed from the body.
+            bool fd_queue = false;
+
+            // Event which is accumulated and delivered at the frame event of its interface instead of immediately.
+            struct Coalesce {
+                enum class mode_t {
+                    // Only the last event is delivered.
+                    LATEST,
+                    // int and fixed arguments are summed, the rest is taken from the last event.
+                    SUM
+                };
+                std::string interface;
+                std::string event;
+                mode_t mode = mode_t::LATEST;
+                // Argument which keeps separate pending event per its value, e.g. touch point id or axis.
+                std::optional<std::string> key;
+            };
+            std::vector<Coalesce> coalesce;
+        };
+
+        // Header which doesn't depend on protocol, path is relative to output directory.
+        struct SupportHeader {
+            std::filesystem::path header;
+            cpp::formatter::text  text;
+        };
+
         // As variable mapper of wayland types to wire_type.h types I think.
-        Builder(std::vector<cpp::include_t> common_includes) : common_includes(common_includes) {}
+        Builder(std::vector<cpp::include_t> common_includes) : Builder(common_includes, Options()) {}
+        Builder(std::vector<cpp::include_t> common_includes, Options options)
+            : common_includes(common_includes), options(options) {}
 
-        cpp::formatter::text build(const wayland::generator::WLInterface&);
+        // Times of tree construction and formatting are added to stats if given.
+        cpp::formatter::text build(const wayland::generator::WLInterface&, Stats::Interface* stats = nullptr);
+        // Appends header to out, which may stream it to a sink.
+        void build(const wayland::generator::WLInterface&, cpp::formatter::text& out, Stats::Interface* stats = nullptr);
+        // Separate steps of build, with arena option set the caller is responsible for arena_scope.
+        cpp::namespace_t build_tree(const wayland::generator::WLInterface&);
+        cpp::formatter::text format(const cpp::namespace_t&);
+        void format(const cpp::namespace_t&, cpp::formatter::text& out);
+        // Estimated sizeof of generated class on LP64, members are laid out in declaration order.
+        std::size_t estimate_size(const wayland::generator::WLInterface&) const;
+        // Headers required by enabled options.
+        std::vector<SupportHeader> support_headers() const;
+        // Throws runtime_error if coalescing options don't fit the interface.
+        void validate(const wayland::generator::WLInterface&) const;
 
     private:
         std::vector<cpp::include_t> common_includes;
+        Options                     options;
         cpp::specifier_t wire_to_type(wire_type type);
         // I guess it can be done with qualified_id_t but I want it to work and touch wayland
         cpp::simple_type_specifier_t socket_type = cpp::simple_type_specifier_t("wire::WLSocket");
         cpp::simple_type_specifier_t void_type   = cpp::simple_type_specifier_t("void");
-        cpp::simple_type_specifier_t string_type = cpp::simple_type_specifier_t("std::string");
         cpp::simple_type_specifier_t wire_object_builder_type = cpp::simple_type_specifier_t("wire::WireObjectBuilder");
         cpp::simple_type_specifier_t uint32_type = cpp::simple_type_specifier_t("uint32_t");
         cpp::simple_type_specifier_t auto_type = cpp::simple_type_specifier_t("auto");
@@ -32,9 +107,30 @@ namespace wayland::generator {
         std::vector<cpp::simple_declaration_t> gen_public_const(const WLInterface& interface);
         std::vector<cpp::type_alias_t> gen_callback_types(const std::vector<WLEvent>& events);
         std::vector<std::string> get_types_list(const std::vector<WLArgument>& arguments);
-        cpp::function_t gen_dispatcher(const std::vector<WLEvent>& events);
-        cpp::parameter_list_t gen_parameters(const std::vector<WLArgument>&);
-        cpp::compound_statement_t gen_request_body(const cpp::function_declaration_t& req);
+        cpp::function_t gen_dispatcher(const WLInterface& interface);
+        // Receiver prefixes event method calls, self prefixes own members of the object.
+        cpp::compound_statement_t gen_event_decode(const WLInterface& interface, const WLEvent& event, std::string_view receiver, std::string_view self);
+        const Options::Coalesce* find_coalesce(const WLInterface& interface, std::string_view event) const;
+        std::vector<cpp::function_t> gen_flush_coalesced(const WLInterface& interface);
+        std::vector<cpp::function_t> gen_coalesce_methods(const WLInterface& interface);
+        std::vector<cpp::simple_declaration_t> gen_coalesce_variables(const WLInterface& interface);
+        std::vector<cpp::function_t> gen_table_dispatcher();
+        std::vector<cpp::function_t> gen_decoders(const WLInterface& interface);
+        // Received fds are passed to dispatch and decoders with fd_queue, unnamed when function doesn't pop any.
+        void add_fd_ring_parameter(cpp::parameter_list_t& params, bool used);
+        cpp::simple_declaration_t gen_decoder_table(const WLInterface& interface);
+        cpp::function_t gen_handler_accessor();
+        cpp::clas gen_handlers(const WLInterface& interface);
+        cpp::parameter_list_t gen_parameters(const std::vector<WLArgument>&, bool event = false);
+        // Type of event argument, differs from wire_to_type with view_args.
+        cpp::specifier_t event_arg_type(wire_type type);
+        std::string event_arg_type_name(wire_type type);
+        cpp::compound_statement_t gen_request_body(const WLRequest& request);
+        // Arguments written into the message body.
+        std::string added_arguments(const WLRequest& request) const;
+        cpp::compound_statement_t gen_queue_fds(const WLRequest& request);
+        cpp::compound_statement_t gen_static_request_body(const WLRequest& request);
+        std::string send_message(std::string_view data, std::string_view size) const;
         std::vector<cpp::enum_specifier_t> gen_enums(const std::vector<WLEnum>& enums);
         std::vector<cpp::function_t> gen_utility(const WLInterface& interface);
         std::vector<cpp::function_t> gen_constructors(const WLInterface& interface);
@@ -0,0 +1,194 @@
+#include "directbuilder.hpp"
+#include "cppbuilder.hpp"
+
+#include <cctype>
+#include <format>
+
+namespace wayland::generator {
+    static std::string_view wire_type_name(wire_type type) {
+        switch (type) {
+            case wire_type::FD:     return "wire::wire_fd_t";
+            case wire_type::FIXED:  return "wire::wire_fixed_t";
+            case wire_type::INT:    return "wire::wire_int_t";
+            case wire_type::UINT:   return "wire::wire_uint_t";
+            case wire_type::NEW_ID: return "wire::wire_new_id_t";
+            case wire_type::OBJECT: return "wire::wire_object_id_t";
+            case wire_type::ARRAY:  return "wire::wire_array_t";
+            case wire_type::STRING: return "wire::wire_string_t";
+        }
+        return "void";
+    }
+
+    // Formats lines with indentation of the formatter, 4 spaces per level, and passes them to text one by one.
+    class Lines {
+    public:
+        explicit Lines(cpp::formatter::text& out) : out(out) {}
+
+        template<typename... Args>
+        void operator()(int level, std::format_string<Args...> fmt, Args&&... args) {
+            line.assign(4 * level, ' ');
+            std::format_to(std::back_inserter(line), fmt, std::forward<Args>(args)...);
+            line += '\n';
+            out << line;
+        }
+
+    private:
+        cpp::formatter::text& out;
+        std::string           line;
+    };
+
+    template<typename Action>
+    static std::string metadata_initializer(const std::vector<Action>& actions) {
+        std::string messages;
+        for (const auto& action : actions) {
+            std::format_to(std::back_inserter(messages), "{}{{ \"{}\", \"{}\" }}", messages.empty() ? "" : ", ", action.name, message_signature(action));
+        }
+        return messages.empty() ? "{}" : std::format("{{{{ {} }}}}", messages);
+    }
+
+    cpp::formatter::text DirectBuilder::build(const WLInterface& interface, Stats::Interface* stats) const {
+        cpp::formatter::text text;
+        build(interface, text, stats);
+        return text;
+    }
+
+    void DirectBuilder::build(const WLInterface& interface, cpp::formatter::text& text, Stats::Interface* stats) const {
+        Stats::Timer timer(stats ? &stats->format : nullptr);
+        for (auto& include : common_includes) {
+            text << include;
+            text << language::newline;
+        }
+        emit(text, interface);
+    }
+
+    void DirectBuilder::emit(cpp::formatter::text& out, const WLInterface& interface) const {
+        Lines line(out);
+        const auto& name = interface.name;
+        bool essential = is_essential(name);
+
+        auto join = [](const auto& items, std::string_view separator, auto&& item) {
+            std::string joined;
+            bool first = true;
+            for (const auto& element : items) {
+                if (!first) {
+                    joined += separator;
+                }
+                joined += item(element);
+                first = false;
+            }
+            return joined;
+        };
+        auto parameters = [&](const std::vector<WLArgument>& args) {
+            return join(args, ", ", [](const WLArgument& arg) { return std::format("{} {}", wire_type_name(arg.type), arg.name); });
+        };
+        auto names = [&](const std::vector<WLArgument>& args, std::string_view separator, std::string_view suffix) {
+            return join(args, separator, [&](const WLArgument& arg) { return std::format("{}{}", arg.name, suffix); });
+        };
+
+        line(0, "#include \"waylandcpp/wire/metadata.hpp\"");
+        line(0, "#include <array>");
+        line(0, "#include <string_view>");
+        line(0, "");
+        line(0, "namespace waylandcpp::interface {{");
+        line(1, "class {} {{", name);
+        line(2, "public:");
+
+        for (const auto& event : interface.events) {
+            line(2, "using {} = callback_t<{}>;", alias_type(event.name),
+                 join(event.arguments, ", ", [](const WLArgument& arg) { return std::string(wire_type_name(arg.type)); }));
+        }
+
+        // Constructors, the second one takes callback of every event.
+        std::string members = "sock( sock ), id_( id_ )";
+        std::string name_param = essential ? "" : ", wire::wire_uint_t && name_ = 0x0";
+        if (!essential) {
+            members += ", name_( name_ )";
+        }
+        line(2, "{}(wire::WLSocket & sock, wire::wire_object_id_t id_ = 0x0{}) : {} {{}}", name, name_param, members);
+        if (!interface.events.empty()) {
+            std::string callbacks;
+            for (const auto& event : interface.events) {
+                callbacks += std::format(", {} && {}", alias_type(event.name), alias_name(event.name));
+                members += std::format(", {0}( {0} )", alias_name(event.name));
+            }
+            line(2, "{}(wire::WLSocket & sock, wire::wire_object_id_t id_{}{}) : {} {{}}", name, callbacks, name_param, members);
+        }
+
+        for (const auto& wlenum : interface.enums) {
+            line(2, "enum class {}_e : uint32_t {{", wlenum.name);
+            for (const auto& entry : wlenum.entries) {
+                bool prefixed = std::isdigit(static_cast<unsigned char>(entry.name[0])) || entry.name == "default";
+                line(3, "{}{} = {},", prefixed ? "_" : "", entry.name, entry.value);
+            }
+            line(2, "}};");
+        }
+
+        line(2, "// Requests");
+        for (const auto& request : interface.requests) {
+            line(2, "void {}({}) {{", request.name, parameters(request.arguments));
+            line(3, "wire::WireObjectBuilder builder(id_, {});", op_code_name(request.name));
+            if (!request.arguments.empty()) {
+                line(3, "builder.add({});", names(request.arguments, ", ", ""));
+            }
+            line(3, "sock.write(builder.data(), builder.size());");
+            line(2, "}}");
+        }
+
+        line(2, "// Events");
+        for (const auto& event : interface.events) {
+            line(2, "virtual void {}({}) {{", event.name, parameters(event.arguments));
+            line(3, "if({})", alias_name(event.name));
+            line(3, "{}({});", alias_name(event.name), names(event.arguments, ", ", ""));
+            line(2, "}}");
+        }
+
+        line(2, "void dispatch(wire::wire_op_t op, wire::WireBufferParser & body) {{");
+        if (interface.events.empty()) {
+            line(3, "switch(op){{}}");
+        } else {
+            line(3, "switch(op){{");
+            for (const auto& event : interface.events) {
+                line(4, "case {}:", op_code_name(event.name));
+                line(5, "{{");
+                if (!event.arguments.empty()) {
+                    line(5, "auto [{}] = body.parse<{}>();", names(event.arguments, ",", "_v"),
+                         join(event.arguments, ",", [](const WLArgument& arg) { return std::string(wire_type_name(arg.type)); }));
+                }
+                line(5, "{}({});", event.name, names(event.arguments, ",", "_v"));
+                line(4, "}}");
+                line(4, "break;");
+            }
+            line(3, "}}");
+        }
+        line(2, "}}");
+
+        line(2, "// Utility");
+        line(2, "auto id() {{");
+        line(3, "return id_;");
+        line(2, "}}");
+
+        line(2, "protected:");
+        for (std::size_t i = 0; i < interface.requests.size(); ++i) {
+            line(2, "static constexpr wire::wire_op_t {} = {:#04x};", op_code_name(interface.requests[i].name), i);
+        }
+        for (std::size_t i = 0; i < interface.events.size(); ++i) {
+            line(2, "static constexpr wire::wire_op_t {} = {:#04x};", op_code_name(interface.events[i].name), i);
+        }
+        line(2, "wire::WLSocket & sock;");
+        line(2, "wire::wire_object_id_t id_;");
+        if (!essential) {
+            line(2, "wire::wire_uint_t name_;");
+        }
+        for (const auto& event : interface.events) {
+            line(2, "{} {};", alias_type(event.name), alias_name(event.name));
+        }
+
+        line(2, "public:");
+        line(2, "static constexpr std::string_view interface = \"{}\";", name);
+        line(2, "static constexpr int version = {};", interface.version);
+        line(2, "static constexpr std::array<wire::MessageMetadata, {}> request_metadata = {};", interface.requests.size(), metadata_initializer(interface.requests));
+        line(2, "static constexpr std::array<wire::MessageMetadata, {}> event_metadata = {};", interface.events.size(), metadata_initializer(interface.events));
+        line(1, "}};");
+        out << std::string("}");
+    }
+}
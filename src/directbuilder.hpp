@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+#include "stats.hpp"
+#include "cpp/declaration/includes.hpp"
+#include "cpp/transform/text.hpp"
+
+namespace wayland::generator {
+    /**
+     * Writes header of an interface straight from the model, without syntax tree.
+     *
+     * Output is byte identical to Builder with default options, --verify checks it.
+     * Builder stays the backend of every other layout, new features go there first.
+     */
+    class DirectBuilder {
+    public:
+        explicit DirectBuilder(std::vector<cpp::include_t> common_includes) : common_includes(common_includes) {}
+
+        // Emission time is added to format of stats if given, there is no ast_build.
+        cpp::formatter::text build(const WLInterface& interface, Stats::Interface* stats = nullptr) const;
+        // Appends header to out line by line, which may stream it to a sink.
+        void build(const WLInterface& interface, cpp::formatter::text& out, Stats::Interface* stats = nullptr) const;
+
+    private:
+        void emit(cpp::formatter::text& out, const WLInterface& interface) const;
+
+        std::vector<cpp::include_t> common_includes;
+    };
+}
@@ -0,0 +1,35 @@
+#include "filesink.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace wayland::generator {
+    FileSink::FileSink(const std::filesystem::path& path) : path(path) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error(std::format("Cannot open '{}': {}", path.string(), std::strerror(errno)));
+        }
+    }
+
+    FileSink::~FileSink() {
+        ::close(fd);
+    }
+
+    void FileSink::write(std::string_view chunk) {
+        while (!chunk.empty()) {
+            auto written = ::write(fd, chunk.data(), chunk.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::format("Cannot write '{}': {}", path.string(), std::strerror(errno)));
+            }
+            chunk.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }
+}
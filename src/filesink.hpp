@@ -0,0 +1,43 @@
+#ifndef WAYLAND_GENERATOR_FILESINK_H
+#define WAYLAND_GENERATOR_FILESINK_H
+
+#include <filesystem>
+#include <string_view>
+
+#include "hash.hpp"
+#include "cpp/transform/text.hpp"
+
+namespace wayland::generator {
+    // Streamed text goes straight to the file descriptor, file is created or truncated, closed on destruction.
+    class FileSink : public cpp::formatter::sink {
+    public:
+        explicit FileSink(const std::filesystem::path& path);
+        ~FileSink() override;
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        void write(std::string_view chunk) override;
+    private:
+        std::filesystem::path path;
+        int                   fd = -1;
+    };
+
+    // Hashes streamed text for the manifest on its way to next sink.
+    class HashingSink : public cpp::formatter::sink {
+    public:
+        explicit HashingSink(cpp::formatter::sink& next) : next(next) {}
+
+        void write(std::string_view chunk) override {
+            hash.update(chunk);
+            next.write(chunk);
+        }
+
+        std::uint64_t value() const { return hash.value(); }
+    private:
+        cpp::formatter::sink& next;
+        Fnv1a                 hash;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_FILESINK_H */
@@ -0,0 +1,24 @@
+#ifndef WAYLAND_GENERATOR_HASH_H
+#define WAYLAND_GENERATOR_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace wayland::generator {
+    // FNV-1a, stable between builds and platforms unlike std::hash. Content can be fed in parts.
+    class Fnv1a {
+    public:
+        Fnv1a& update(std::string_view bytes) {
+            for (unsigned char byte : bytes) {
+                hash = (hash ^ byte) * 0x100000001b3;
+            }
+            return *this;
+        }
+
+        std::uint64_t value() const { return hash; }
+    private:
+        std::uint64_t hash = 0xcbf29ce484222325;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_HASH_H */
@@ -3,6 +3,12 @@
 #include <sstream>
 #include <format>
 #include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <map>
+#include <ranges>
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
@@ -10,6 +16,15 @@
 #include "protocol.hpp"
 #include "wlstream.hpp"
 #include "cppbuilder.hpp"
+#include "directbuilder.hpp"
+#include "filesink.hpp"
+#include "selection.hpp"
+#include "protocolindex.hpp"
+#include "buildfiles.hpp"
+#include "threadpool.hpp"
+#include "xmlreader.hpp"
+#include "mappedfile.hpp"
+#include "modelcache.hpp"
 
 // CPP
 #include "cpp/declaration/class.hpp"
@@ -24,7 +39,8 @@ public:
     /**
      * Parse input strings.
      *
-     * Parse input of the form "--config" "<CONFIG>" "--output" "<OUTPUT>" --dry-run
+     * Parse input of the form "--config" "<CONFIG>" "--protocols" "<DIR>" "--output" "<OUTPUT>" "--jobs" "<N>" "--parser" "<PARSER>" "--cache-dir" "<DIR>" "--depfile" "<FILE>" "--manifest" "<FILE>" "--backend" "<BACKEND>" "--interfaces" "<A,B,C>" --dry-run --verify --incremental --stream --arena --stats --static-marshal --corked --fd-queue --crtp --view-args --compact --size-report --dispatch <DISPATCH> --coalesce <EVENT>
+     * "--config" and "--protocols" can be repeated to generate several protocols at once, "--coalesce" once per event.
      * In case of other options throws runtime_error("Unknown option: <option_name>")
      */
     GeneratorArgs(int argc, char *argv[]) {
@@ -41,6 +57,66 @@ public:
                 continue;
             }
 
+            if (arg == "compact") {
+                compact = true;
+                continue;
+            }
+
+            if (arg == "size-report") {
+                size_report = true;
+                continue;
+            }
+
+            if (arg == "view-args") {
+                view_args = true;
+                continue;
+            }
+
+            if (arg == "crtp") {
+                crtp = true;
+                continue;
+            }
+
+            if (arg == "fd-queue") {
+                fd_queue = true;
+                continue;
+            }
+
+            if (arg == "corked") {
+                corked = true;
+                continue;
+            }
+
+            if (arg == "static-marshal") {
+                static_marshal = true;
+                continue;
+            }
+
+            if (arg == "stats") {
+                stats = true;
+                continue;
+            }
+
+            if (arg == "arena") {
+                arena = true;
+                continue;
+            }
+
+            if (arg == "stream") {
+                stream = true;
+                continue;
+            }
+
+            if (arg == "incremental") {
+                incremental = true;
+                continue;
+            }
+
+            if (arg == "verify") {
+                verify = true;
+                continue;
+            }
+
             if (arg == "help") {
                 help = true;
                 break;
@@ -50,21 +126,279 @@ public:
                 throw std::runtime_error(std::format("Cannot find value for option: '{}'", arg));
             }
             if (arg == "config") {
-                config = argv[++i]; 
+                configs.emplace_back(argv[++i]);
+            } else if (arg == "protocols") {
+                protocol_dirs.emplace_back(argv[++i]);
             } else if (arg == "output") {
                 output = argv[++i];
+            } else if (arg == "depfile") {
+                depfile = fs::path(argv[++i]);
+            } else if (arg == "manifest") {
+                manifest = fs::path(argv[++i]);
+            } else if (arg == "cache-dir") {
+                cache_dir = fs::path(argv[++i]);
+            } else if (arg == "parser") {
+                std::string value(argv[++i]);
+                if (value == "stream") {
+                    parser = parser_t::STREAM;
+                } else if (value == "ptree") {
+                    parser = parser_t::PTREE;
+                } else {
+                    throw std::runtime_error(std::format("Parser '{}' is not supported!", value));
+                }
+            } else if (arg == "backend") {
+                std::string value(argv[++i]);
+                if (value == "ast") {
+                    backend = backend_t::AST;
+                } else if (value == "direct") {
+                    backend = backend_t::DIRECT;
+                } else {
+                    throw std::runtime_error(std::format("Backend '{}' is not supported!", value));
+                }
+            } else if (arg == "dispatch") {
+                std::string value(argv[++i]);
+                if (value == "switch") {
+                    table_dispatch = false;
+                } else if (value == "table") {
+                    table_dispatch = true;
+                } else {
+                    throw std::runtime_error(std::format("Dispatch '{}' is not supported!", value));
+                }
+            } else if (arg == "interfaces") {
+                std::string_view value(argv[++i]);
+                for (auto name : std::views::split(value, ',')) {
+                    if (name.empty()) {
+                        throw std::runtime_error(std::format("Option 'interfaces' expects comma separated names, got: '{}'", value));
+                    }
+                    interfaces.emplace_back(name.begin(), name.end());
+                }
+            } else if (arg == "coalesce") {
+                coalesce.push_back(parse_coalesce(argv[++i]));
+            } else if (arg == "jobs") {
+                std::string value(argv[++i]);
+                try {
+                    jobs = std::stoul(value);
+                } catch (const std::exception&) {
+                    throw std::runtime_error(std::format("Option 'jobs' expects a number, got: '{}'", value));
+                }
             } else {
                 throw std::runtime_error(std::format("Option '{}' is not supported!", arg));
             }
         }
+
+        for (const auto& dir : protocol_dirs) {
+            if (!fs::is_directory(dir)) {
+                throw std::runtime_error(std::format("Protocol dir: '{}' doesn't exist!", dir.string()));
+            }
+            // Directory order is unspecified, sort to keep output stable.
+            std::vector<fs::path> found;
+            for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+                    found.push_back(entry.path());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            configs.insert(configs.end(), found.begin(), found.end());
+        }
+
+        batch = configs.size() > 1 || !protocol_dirs.empty();
+
+        if (stats && verify) {
+            throw std::runtime_error("Option 'stats' can't be combined with 'verify'!");
+        }
+        if (compact && crtp) {
+            throw std::runtime_error("Option 'compact' can't be combined with 'crtp'!");
+        }
+        if (fd_queue && !corked) {
+            throw std::runtime_error("Option 'fd-queue' requires 'corked'!");
+        }
+        // Streamed header is never held in memory whole, so there is nothing to compare or report before writing.
+        for (auto [set, option] : { std::pair{ incremental, "incremental" }, std::pair{ dry_run, "dry-run" }, std::pair{ size_report, "size-report" } }) {
+            if (stream && set) {
+                throw std::runtime_error(std::format("Option 'stream' can't be combined with '{}'!", option));
+            }
+        }
+        if (dry_run && (depfile || manifest)) {
+            throw std::runtime_error("Options 'depfile' and 'manifest' can't be combined with 'dry-run'!");
+        }
+        if (stream && !interfaces.empty()) {
+            throw std::runtime_error("Option 'stream' can't be combined with 'interfaces'!");
+        }
+        // Direct backend writes only the default layout.
+        if (backend == backend_t::DIRECT) {
+            std::pair<bool, std::string_view> ast_only[] = {
+                { arena, "arena" }, { static_marshal, "static-marshal" }, { corked, "corked" }, { fd_queue, "fd-queue" },
+                { table_dispatch, "dispatch" }, { crtp, "crtp" }, { view_args, "view-args" }, { compact, "compact" },
+                { !coalesce.empty(), "coalesce" }
+            };
+            for (auto [set, option] : ast_only) {
+                if (set) {
+                    throw std::runtime_error(std::format("Option '{}' can't be combined with 'backend direct'!", option));
+                }
+            }
+        }
+
+        if (configs.empty()) {
+            configs.emplace_back("/usr/share/wayland/wayland.xml");
+        }
     }
 
-    fs::path config = "/usr/share/wayland/wayland.xml";
+    enum class parser_t {
+        STREAM,
+        PTREE
+    };
+
+    enum class backend_t {
+        AST,
+        DIRECT
+    };
+
+    std::vector<fs::path> configs;
+    std::vector<fs::path> protocol_dirs;
+    parser_t parser = parser_t::STREAM;
+    backend_t backend = backend_t::AST;
     fs::path output = "tmp";
+    std::optional<fs::path> cache_dir;
+    std::optional<fs::path> depfile;
+    std::optional<fs::path> manifest;
+    // 1 keeps generation serial, 0 picks number of hardware threads.
+    std::size_t jobs = 1;
+    // With several protocols each of them gets its own subdirectory.
+    bool batch = false;
     bool dry_run = false;
+    bool verify = false;
+    bool incremental = false;
+    bool stream = false;
+    bool arena = false;
+    bool stats = false;
+    bool static_marshal = false;
+    bool corked = false;
+    bool fd_queue = false;
+    bool table_dispatch = false;
+    bool crtp = false;
+    bool view_args = false;
+    bool compact = false;
+    bool size_report = false;
     bool help = false;
+    // Roots of --interfaces, empty generates every interface.
+    std::vector<std::string> interfaces;
+    std::vector<wg::Builder::Options::Coalesce> coalesce;
+
+private:
+    // <interface>.<event>[:latest|sum[:<key argument>]]
+    static wg::Builder::Options::Coalesce parse_coalesce(std::string_view value) {
+        using mode_t = wg::Builder::Options::Coalesce::mode_t;
+        wg::Builder::Options::Coalesce coalesce;
+        auto invalid = [&]() {
+            return std::runtime_error(std::format("Coalesce '{}' is not <interface>.<event>[:latest|sum[:<key>]]!", value));
+        };
+
+        auto colon = value.find(':');
+        auto event = value.substr(0, colon);
+        auto dot = event.find('.');
+        if (dot == std::string_view::npos || dot == 0 || dot + 1 == event.size()) {
+            throw invalid();
+        }
+        coalesce.interface = event.substr(0, dot);
+        coalesce.event = event.substr(dot + 1);
+        if (colon == std::string_view::npos) {
+            return coalesce;
+        }
+
+        auto rest = value.substr(colon + 1);
+        colon = rest.find(':');
+        auto mode = rest.substr(0, colon);
+        if (mode == "latest") {
+            coalesce.mode = mode_t::LATEST;
+        } else if (mode == "sum") {
+            coalesce.mode = mode_t::SUM;
+        } else {
+            throw invalid();
+        }
+        if (colon != std::string_view::npos) {
+            if (colon + 1 == rest.size()) {
+                throw invalid();
+            }
+            coalesce.key = std::string(rest.substr(colon + 1));
+        }
+        return coalesce;
+    }
 };
 
+static wg::WLProtocol load_protocol(const fs::path& config, GeneratorArgs::parser_t parser, wg::Stats::Protocol* stats = nullptr) {
+    if (parser == GeneratorArgs::parser_t::PTREE) {
+        return wg::WLProtocol::load_ptree(config, stats);
+    }
+    return wg::WLProtocol::load_mapped(config, stats);
+}
+
+// Model from the cache when xml didn't change, otherwise parsed and stored for the next run.
+static wg::WLProtocol load_protocol(const fs::path& config, GeneratorArgs::parser_t parser, const wg::ModelCache& cache, wg::Stats::Protocol* stats = nullptr) {
+    std::uint64_t key;
+    {
+        wg::Stats::Timer timer(stats ? &stats->xml_load : nullptr);
+        wg::MappedFile xml(config);
+        key = wg::ModelCache::key(xml.view());
+    }
+    {
+        wg::Stats::Timer timer(stats ? &stats->model_build : nullptr);
+        if (auto cached = cache.find(key)) {
+            if (stats) {
+                stats->cached = true;
+            }
+            return std::move(cached.value());
+        }
+    }
+
+    auto protocol = load_protocol(config, parser, stats);
+    cache.store(key, protocol);
+    return protocol;
+}
+
+// Checks that both backends write the same header of every interface, reports first differing line otherwise.
+static bool verify_backends(const fs::path& config, const wg::WLProtocol& protocol, const std::vector<cpp::include_t>& includes) {
+    wg::Builder ast(includes);
+    wg::DirectBuilder direct(includes);
+    bool same = true;
+    for (const auto& interface : protocol.interfaces) {
+        auto expected = ast.build(interface).str();
+        auto written = direct.build(interface).str();
+        if (expected == written) {
+            continue;
+        }
+
+        same = false;
+        auto mismatch = std::ranges::mismatch(expected, written).in1 - expected.begin();
+        auto line = std::count(expected.begin(), expected.begin() + mismatch, '\n') + 1;
+        std::cerr << std::format("{}: direct backend header of '{}' differs from ast backend at line {}\n", config.string(), interface.name, line);
+    }
+    return same;
+}
+
+// Checks that every parser produces the same model and both backends the same headers,
+// returns false and reports differences otherwise.
+static bool verify_protocol(const fs::path& config, const std::vector<cpp::include_t>& includes) {
+    auto reference = load_protocol(config, GeneratorArgs::parser_t::PTREE);
+    auto streamed = load_protocol(config, GeneratorArgs::parser_t::STREAM);
+    if (reference == streamed) {
+        return verify_backends(config, streamed, includes);
+    }
+
+    std::cerr << std::format("{}: stream parser model differs from ptree parser model\n", config.string());
+    if (reference.name != streamed.name) {
+        std::cerr << std::format("  protocol name: '{}' != '{}'\n", reference.name, streamed.name);
+    }
+    if (reference.interfaces.size() != streamed.interfaces.size()) {
+        std::cerr << std::format("  number of interfaces: {} != {}\n", reference.interfaces.size(), streamed.interfaces.size());
+    }
+    for (std::size_t i = 0; i < std::min(reference.interfaces.size(), streamed.interfaces.size()); ++i) {
+        if (reference.interfaces[i] != streamed.interfaces[i]) {
+            std::cerr << "  ptree:\n" << reference.interfaces[i] << "  stream:\n" << streamed.interfaces[i];
+        }
+    }
+    return false;
+}
+
 int main(int argc, char *argv[]) {
     GeneratorArgs args(argc, argv);
 
@@ -73,65 +407,385 @@ int main(int argc, char *argv[]) {
         std::cout << "  --help show this help message\n";
         std::cout << "  --dry-run list headers files to generate\n";
         std::cout << "  --output change <OUTPUT> variable, defaults to ./tmp, ignored if --dry-run set\n";
-        std::cout << "  --config path to wayland specification xml, defaults to \"/usr/share/wayland/wayland.xml\"" << std::endl;
+        std::cout << "  --config path to wayland specification xml, defaults to \"/usr/share/wayland/wayland.xml\", can be repeated\n";
+        std::cout << "  --protocols directory searched recursively for wayland specification xmls, can be repeated\n";
+        std::cout << "  --jobs number of protocols and interfaces processed concurrently, 0 uses all hardware threads, defaults to 1\n";
+        std::cout << "  --interfaces comma separated interfaces to generate together with interfaces their object and new_id arguments refer to, can be repeated\n";
+        std::cout << "  --parser xml frontend, one of: stream (default), ptree\n";
+        std::cout << "  --cache-dir directory with binary models of parsed xmls, unchanged xmls are not parsed again\n";
+        std::cout << "  --backend header emission, one of: ast (default), direct (writes text straight from the model, default layout only)\n";
+        std::cout << "  --depfile write Make/Ninja depfile: all generated headers depend on specification xmls and generator binary, with --manifest its only target is the manifest\n";
+        std::cout << "  --manifest write list of generated headers with their content hash and size, relative to <OUTPUT>\n";
+        std::cout << "  --incremental rewrite only headers which content changed\n";
+        std::cout << "  --stream write headers through fixed size buffer while they are generated, load and release protocols one by one, memory is bounded by the largest protocol model plus per job the buffer and ast of the largest interface\n";
+        std::cout << "  --arena allocate syntax tree of every interface in one arena\n";
+        std::cout << "  --static-marshal compute request sizes at generation time, fixed size requests are encoded on stack\n";
+        std::cout << "  --corked requests are queued in connection buffer and sent on flush, generates include/waylandcpp/wire/outgoing_buffer.hpp\n";
+        std::cout << "  --fd-queue fds of requests are sent as SCM_RIGHTS with the next batch, fds of events are taken from wire::FdRing passed to dispatch, requires --corked\n";
+        std::cout << "  --crtp generate interfaces as template<typename Handler> bases, events are delivered to Handler statically\n";
+        std::cout << "  --view-args string and array event arguments are views into receive buffer, valid during the event\n";
+        std::cout << "  --compact objects keep pointer to shared handlers table instead of callback per event\n";
+        std::cout << "  --size-report print estimated size of every generated class, with default layout for comparison\n";
+        std::cout << "  --dispatch event dispatch, one of: switch (default), table\n";
+        std::cout << "  --coalesce <interface>.<event>[:latest|sum[:<key>]] deliver event at frame: latest one (default) or int and fixed arguments summed, separately per key argument, can be repeated\n";
+        std::cout << "  --stats print json report with phase times, allocations, peak memory and written files\n";
+        std::cout << "  --verify check that all xml frontends produce the same model and both backends the same headers, nothing is generated\n";
+        std::cout << "With more than one specification headers of every protocol are placed in include/waylandcpp/<PROTOCOL>" << std::endl;
         return 0;
     }
 
-    std::vector<wg::WLInterface> interfaces;
-    pt::ptree tree;
+    // Created first, so it covers whole run.
+    std::optional<wg::Stats> stats;
+    if (args.stats) {
+        stats.emplace(args.jobs);
+        stats->protocols.resize(args.configs.size());
+    }
 
-    // TODO: Maybe add debug login later
-    //std::cout << std::format("Parsing wayland protocol spec: '{}', generated source dir: '{}'", args.config.string(), args.output.string()) << std::endl;
-    pt::read_xml(args.config, tree);
-    auto xml_interfaces = tree.get_child("protocol");
+    std::optional<wg::ThreadPool> pool;
+    if (args.jobs != 1) {
+        pool.emplace(args.jobs);
+    }
+    auto pool_ptr = pool ? &pool.value() : nullptr;
+
+    std::vector<std::size_t> indices(args.configs.size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::vector<cpp::include_t> includes;
+    includes.push_back(cpp::AngleInclusion("string"));
+    includes.push_back(cpp::AngleInclusion("vector"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/types.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/socket.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/object_builder.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/buffer_parser.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/callback.hpp"));
+
+    if (args.verify) {
+        std::vector<char> verified(args.configs.size());
+        wg::for_each_job(pool_ptr, indices, [&](std::size_t index) {
+            verified[index] = verify_protocol(args.configs[index], includes);
+        });
+        return std::ranges::all_of(verified, [](char ok) { return ok; }) ? 0 : 1;
+    }
 
-    // Q: Why this form sometimes doesn't work?
-    auto protocol_name = tree.get_child("protocol.<xmlattr>.name").data();
-    // TODO: Maybe add debug login later
-    //std::cout << "Protocol name: " << protocol_name << std::endl;
-    for (auto& interface: xml_interfaces) {
-        if (interface.first == "interface") {
-            interfaces.push_back(wg::WLInterface::create_from_xml(interface.second));
+    std::optional<wg::ModelCache> cache;
+    if (args.cache_dir) {
+        cache.emplace(args.cache_dir.value());
+    }
+
+    auto load = [&](std::size_t index) {
+        auto protocol_stats = stats ? &stats->protocols[index] : nullptr;
+        auto protocol = cache ? load_protocol(args.configs[index], args.parser, cache.value(), protocol_stats)
+                              : load_protocol(args.configs[index], args.parser, protocol_stats);
+        if (protocol_stats) {
+            protocol_stats->name = std::string(protocol.name);
+            protocol_stats->config = args.configs[index];
+        }
+        return protocol;
+    };
+
+    // Names are copied, with --stream protocols are released before the next one is loaded.
+    std::set<std::string, std::less<>> protocol_names;
+    auto check_protocol_name = [&](std::string_view name, std::size_t index) {
+        if (!protocol_names.insert(std::string(name)).second) {
+            throw std::runtime_error(std::format("Protocol '{}' from '{}' is specified more than once!", name, args.configs[index].string()));
+        }
+    };
+
+    // Model is missing only in indexed dry run, for interfaces which don't have to be validated.
+    struct Target {
+        std::string_view       protocol;
+        std::string_view       name;
+        const wg::WLInterface* interface;
+        fs::path               header;
+    };
+
+    fs::path include_dir = fs::path("include") / "waylandcpp";
+    auto header_path = [&](std::string_view protocol, std::string_view interface) {
+        auto header_file = (args.batch ? include_dir / protocol : include_dir) / interface;
+        header_file.replace_extension("hpp");
+        return header_file;
+    };
+    auto add_targets = [&](const wg::WLProtocol& protocol, std::vector<Target>& targets) {
+        for (const auto& interface : protocol.interfaces) {
+            targets.push_back({ protocol.name, interface.name, &interface, header_path(protocol.name, interface.name) });
+        }
+    };
+
+    wg::Builder::Options options;
+    options.arena = args.arena;
+    options.static_marshal = args.static_marshal;
+    options.corked = args.corked;
+    options.fd_queue = args.fd_queue;
+    options.table_dispatch = args.table_dispatch;
+    options.crtp = args.crtp;
+    options.view_args = args.view_args;
+    options.compact = args.compact;
+    options.coalesce = args.coalesce;
+    wayland::generator::Builder builder(includes, options);
+    wayland::generator::DirectBuilder direct(includes);
+
+    std::vector<char> coalesce_found(args.coalesce.size());
+    auto check_targets = [&](const std::vector<Target>& targets) {
+        for (const auto& target : targets) {
+            for (std::size_t i = 0; i < args.coalesce.size(); ++i) {
+                coalesce_found[i] |= target.name == args.coalesce[i].interface;
+            }
+            if (target.interface) {
+                builder.validate(*target.interface);
+            }
+        }
+    };
+    auto check_coalesce_found = [&]() {
+        for (std::size_t i = 0; i < args.coalesce.size(); ++i) {
+            if (!coalesce_found[i]) {
+                throw std::runtime_error(std::format("Interface '{}' of coalesced event '{}' is not found!", args.coalesce[i].interface, args.coalesce[i].event));
+            }
         }
+    };
+    auto support_headers = builder.support_headers();
+
+    auto create_header_dirs = [&](const std::vector<Target>& targets) {
+        std::set<fs::path> header_dirs;
+        for (const auto& target : targets) {
+            header_dirs.insert(args.output / target.header.parent_path());
+        }
+        for (const auto& dir : header_dirs) {
+            std::filesystem::create_directories(dir);
+        }
+    };
+
+    // Every interface is written to its own file, so output doesn't depend on execution order.
+    auto generate = [&](const Target& target, wg::Stats::Interface* interface_stats, wg::ManifestEntry* manifest_entry) {
+        auto emit = [&](cpp::formatter::text& text) {
+            if (args.backend == GeneratorArgs::backend_t::DIRECT) {
+                direct.build(*target.interface, text, interface_stats);
+            } else {
+                builder.build(*target.interface, text, interface_stats);
+            }
+        };
+
+        auto header_file = args.output / target.header;
+        bool written = true;
+        std::size_t bytes = 0;
+        std::uint64_t hash = 0;
+        if (args.stream) {
+            // Only one buffer of text is kept, full parts of it are written while header is generated.
+            wg::FileSink file(header_file);
+            wg::HashingSink sink(file);
+            cpp::formatter::text text(sink);
+            emit(text);
+            wg::Stats::Timer timer(interface_stats ? &interface_stats->write : nullptr);
+            text.flush();
+            bytes = text.size();
+            hash = sink.value();
+        } else {
+            cpp::formatter::text text;
+            emit(text);
+            wg::Stats::Timer timer(interface_stats ? &interface_stats->write : nullptr);
+            if (args.incremental) {
+                written = text.update_file(header_file);
+            } else {
+                text.to_file(header_file);
+            }
+            bytes = text.size();
+            if (manifest_entry) {
+                hash = wg::Fnv1a().update(text.str()).value();
+            }
+        }
+        if (interface_stats) {
+            interface_stats->bytes = bytes;
+            interface_stats->written = written;
+        }
+        if (manifest_entry) {
+            *manifest_entry = { target.header, hash, bytes };
+        }
+    };
+
+    // Every generated file, for --depfile and --manifest.
+    std::vector<fs::path> outputs;
+    std::vector<wg::ManifestEntry> manifest;
+    auto generate_all = [&](const std::vector<Target>& targets) {
+        for (const auto& target : targets) {
+            outputs.push_back(args.output / target.header);
+        }
+        std::size_t first_manifest = manifest.size();
+        if (args.manifest) {
+            manifest.resize(first_manifest + targets.size());
+        }
+        std::size_t first_stats = 0;
+        if (stats) {
+            first_stats = stats->interfaces.size();
+            for (const auto& target : targets) {
+                stats->interfaces.push_back({ std::string(target.protocol), std::string(target.name), target.header });
+            }
+        }
+        wg::for_each_job(pool_ptr, targets, [&](const Target& target) {
+            auto index = &target - targets.data();
+            auto interface_stats = stats ? &stats->interfaces[first_stats + index] : nullptr;
+            generate(target, interface_stats, args.manifest ? &manifest[first_manifest + index] : nullptr);
+        });
+    };
+
+    auto write_support_headers = [&]() {
+        for (auto& support : support_headers) {
+            auto header_file = args.output / support.header;
+            std::filesystem::create_directories(header_file.parent_path());
+            if (args.incremental) {
+                support.text.update_file(header_file);
+            } else {
+                support.text.to_file(header_file);
+            }
+            outputs.push_back(header_file);
+            if (args.manifest) {
+                manifest.push_back({ support.header, wg::Fnv1a().update(support.text.str()).value(), support.text.size() });
+            }
+        }
+    };
+
+    if (!args.dry_run && !std::filesystem::exists(args.output)) {
+        throw std::runtime_error(std::format("Output dir: '{}' doesn't exist!", args.output.string()));
     }
 
-    if (args.dry_run) {
-        for (auto& interface : interfaces) {
-            std::cout << std::format("{}/{}.hpp\n", "include/waylandcpp", interface.name);
+    if (args.stream) {
+        // Protocols are loaded, generated and released one by one, so memory doesn't grow with their number.
+        write_support_headers();
+        for (auto index : indices) {
+            auto protocol = load(index);
+            check_protocol_name(protocol.name, index);
+            std::vector<Target> targets;
+            add_targets(protocol, targets);
+            check_targets(targets);
+            create_header_dirs(targets);
+            generate_all(targets);
         }
+        check_coalesce_found();
     } else {
-        std::vector<cpp::include_t> includes;
-        includes.push_back(cpp::AngleInclusion("string"));
-        includes.push_back(cpp::AngleInclusion("vector"));
-        includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/types.hpp"));
-        includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/socket.hpp"));
-        includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/object_builder.hpp"));
-        includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/buffer_parser.hpp"));
-        includes.push_back(cpp::QuoteInclusion("waylandcpp/callback.hpp"));
+        // With the stream parser dry run and --interfaces read only index of every specification,
+        // interfaces are parsed when they are generated, reported, reached from --interfaces or validated for --coalesce.
+        bool indexed = args.parser == GeneratorArgs::parser_t::STREAM && !args.cache_dir && (args.dry_run || !args.interfaces.empty());
+        bool need_models = !args.dry_run || args.size_report;
 
-        wayland::generator::Builder builder(includes);
+        std::vector<wg::WLProtocol> protocols;
+        std::vector<std::optional<wg::ProtocolIndex>> indexes;
+        // Node based, targets point to parsed interfaces.
+        std::map<const wg::ProtocolIndex::Entry*, wg::WLInterface> parsed;
+        std::vector<Target> targets;
+        if (indexed) {
+            indexes.resize(args.configs.size());
+            wg::for_each_job(pool_ptr, indices, [&](std::size_t index) {
+                auto protocol_stats = stats ? &stats->protocols[index] : nullptr;
+                indexes[index].emplace(args.configs[index], protocol_stats);
+                if (protocol_stats) {
+                    protocol_stats->name = std::string(indexes[index]->name());
+                    protocol_stats->config = args.configs[index];
+                }
+            });
 
-        if(!std::filesystem::exists(args.output)) {
-            throw std::runtime_error(std::format("Output dir: '{}' doesn't exist!", args.output.string()));
+            auto parse = [&](std::size_t index, const wg::ProtocolIndex::Entry& entry) -> const wg::WLInterface* {
+                if (auto found = parsed.find(&entry); found != parsed.end()) {
+                    return &found->second;
+                }
+                wg::Stats::Timer timer(stats ? &stats->protocols[index].model_build : nullptr);
+                return &parsed.emplace(&entry, indexes[index]->parse(entry)).first->second;
+            };
+            // The first specification with the name is used, like with fully loaded models.
+            std::map<std::string_view, std::pair<std::size_t, const wg::ProtocolIndex::Entry*>> entries;
+            for (std::size_t i = 0; i < indexes.size(); ++i) {
+                check_protocol_name(indexes[i]->name(), i);
+                for (const auto& entry : indexes[i]->interfaces()) {
+                    entries.emplace(entry.name, std::pair{ i, &entry });
+                }
+            }
+            auto lookup = [&](std::string_view name) -> const wg::WLInterface* {
+                auto found = entries.find(name);
+                return found != entries.end() ? parse(found->second.first, *found->second.second) : nullptr;
+            };
+
+            std::optional<wg::InterfaceSet> selected;
+            if (!args.interfaces.empty()) {
+                selected = wg::interface_closure(args.interfaces, lookup);
+            }
+            for (const auto& coalesce : args.coalesce) {
+                if (!selected || selected->contains(coalesce.interface)) {
+                    lookup(coalesce.interface);
+                }
+            }
+            for (std::size_t i = 0; i < indexes.size(); ++i) {
+                for (const auto& entry : indexes[i]->interfaces()) {
+                    if (selected && !selected->contains(entry.name)) {
+                        continue;
+                    }
+                    auto interface = need_models || parsed.contains(&entry) ? parse(i, entry) : nullptr;
+                    targets.push_back({ indexes[i]->name(), entry.name, interface, header_path(indexes[i]->name(), entry.name) });
+                }
+            }
+        } else {
+            protocols.resize(args.configs.size());
+            wg::for_each_job(pool_ptr, indices, [&](std::size_t index) {
+                protocols[index] = load(index);
+            });
+
+            for (std::size_t i = 0; i < protocols.size(); ++i) {
+                check_protocol_name(protocols[i].name, i);
+                add_targets(protocols[i], targets);
+            }
+            if (!args.interfaces.empty()) {
+                std::map<std::string_view, const wg::WLInterface*> known;
+                for (const auto& target : targets) {
+                    known.emplace(target.name, target.interface);
+                }
+                auto selected = wg::interface_closure(args.interfaces, [&](std::string_view name) -> const wg::WLInterface* {
+                    auto found = known.find(name);
+                    return found != known.end() ? found->second : nullptr;
+                });
+                std::erase_if(targets, [&](const Target& target) { return !selected.contains(target.name); });
+            }
         }
+        check_targets(targets);
+        check_coalesce_found();
 
-        auto header_dir = args.output / "include" / "waylandcpp";
-        std::filesystem::create_directory(header_dir.parent_path());
-        std::filesystem::create_directory(header_dir);
+        if (args.size_report) {
+            wayland::generator::Builder reference(includes);
+            std::cout << std::format("{:<48} {:>8} {:>8}\n", "interface", "bytes", "default");
+            for (const auto& target : targets) {
+                std::cout << std::format("{:<48} {:>8} {:>8}\n", target.name,
+                                         builder.estimate_size(*target.interface), reference.estimate_size(*target.interface));
+            }
+        }
 
-        //auto source_dir = args.output / "src";
-        //std::filesystem::create_directory(source_dir);
+        if (args.dry_run) {
+            for (auto& target : targets) {
+                std::cout << std::format("{}\n", target.header.string());
+            }
+            for (auto& support : support_headers) {
+                std::cout << std::format("{}\n", support.header.string());
+            }
+        } else {
+            write_support_headers();
 
-        for (const auto& interface : interfaces) {
-            auto text = builder.build(interface);
+            create_header_dirs(targets);
+            generate_all(targets);
+        }
+    }
 
-            auto header_file = header_dir / interface.name;
-            header_file.replace_extension("hpp");
-            //std::cout << "HEADER: " << header_file << std::endl;
-            //std::cout << text << std::endl;
-            text.to_file(header_file);
+    if (args.depfile) {
+        // Generator itself is an input too, new version may generate different headers.
+        std::error_code ec;
+        auto generator = fs::read_symlink("/proc/self/exe", ec);
+        std::vector<fs::path> inputs = args.configs;
+        inputs.push_back(ec ? fs::absolute(argv[0]) : generator);
+        // Manifest is the stamp build rule declares as its output, Ninja expects only outputs of the edge as targets.
+        if (args.manifest) {
+            outputs = { args.manifest.value() };
         }
+        wg::write_depfile(args.depfile.value(), outputs, inputs);
+    }
+    if (args.manifest) {
+        wg::write_manifest(args.manifest.value(), manifest);
+    }
 
+    if (stats) {
+        stats->write_json(std::cout);
     }
 
     return 0;
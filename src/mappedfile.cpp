@@ -0,0 +1,47 @@
+#include "mappedfile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wayland::generator {
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error(std::format("Cannot open '{}': {}", path.string(), std::strerror(errno)));
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) < 0) {
+            auto error = errno;
+            ::close(fd);
+            throw std::runtime_error(std::format("Cannot stat '{}': {}", path.string(), std::strerror(error)));
+        }
+
+        size = static_cast<std::size_t>(st.st_size);
+        // Zero length mapping is not allowed, empty view is enough in that case.
+        if (size > 0) {
+            data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                auto error = errno;
+                data = nullptr;
+                ::close(fd);
+                throw std::runtime_error(std::format("Cannot map '{}': {}", path.string(), std::strerror(error)));
+            }
+            ::madvise(data, size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data) {
+            ::munmap(data, size);
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef WAYLAND_GENERATOR_MAPPEDFILE_H
+#define WAYLAND_GENERATOR_MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace wayland::generator {
+    // Read only private mapping of the whole file, unmapped on destruction.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view view() const { return { static_cast<const char *>(data), size }; }
+    private:
+        void*       data = nullptr;
+        std::size_t size = 0;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_MAPPEDFILE_H */
@@ -0,0 +1,367 @@
+#include "modelcache.hpp"
+#include "mappedfile.hpp"
+#include "hash.hpp"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#ifndef WAYLANDCPP_GENERATOR_VERSION
+#define WAYLANDCPP_GENERATOR_VERSION "unknown"
+#endif
+
+namespace wayland::generator {
+    namespace {
+        // Bumped with every change of records below or of the model they describe.
+        constexpr std::uint32_t format_version = 1;
+        constexpr std::array<char, 8> magic = { 'W', 'L', 'M', 'O', 'D', 'E', 'L', '\0' };
+        // Offset of absent optional string.
+        constexpr std::uint32_t none = 0xffffffff;
+
+        // Entry is header followed by arrays of records in declaration order and string pool.
+        // Records have only 32 bit fields, so they have no padding and stay aligned in the mapping.
+        struct Str {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        struct Range {
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        struct DescriptionRecord {
+            Str description;
+            Str summary;
+        };
+
+        struct InterfaceRecord {
+            Str               name;
+            DescriptionRecord description;
+            std::int32_t      version;
+            Range             requests;
+            Range             events;
+            Range             enums;
+        };
+
+        struct ActionRecord {
+            Str               name;
+            DescriptionRecord description;
+            std::int32_t      since;
+            Range             arguments;
+        };
+
+        struct ArgumentRecord {
+            Str           name;
+            Str           summary;
+            std::uint32_t type;
+            Str           arg_enum;
+            Str           arg_interface;
+            std::uint32_t allow_null;
+        };
+
+        struct EnumRecord {
+            Str               name;
+            std::uint32_t     bitfield;
+            std::uint32_t     has_description;
+            DescriptionRecord description;
+            Range             entries;
+        };
+
+        struct EntryRecord {
+            Str name;
+            Str value;
+            Str summary;
+        };
+
+        struct Header {
+            std::array<char, 8> magic;
+            std::uint32_t       format;
+            std::uint32_t       reserved;
+            std::uint64_t       key;
+            Str                 name;
+            std::uint32_t       interfaces;
+            std::uint32_t       actions;
+            std::uint32_t       arguments;
+            std::uint32_t       enums;
+            std::uint32_t       entries;
+            std::uint32_t       strings;
+        };
+
+        static_assert(sizeof(Header) % alignof(Header) == 0);
+        static_assert(sizeof(InterfaceRecord) % 4 == 0 && sizeof(ActionRecord) % 4 == 0 && sizeof(ArgumentRecord) % 4 == 0);
+        static_assert(sizeof(EnumRecord) % 4 == 0 && sizeof(EntryRecord) % 4 == 0);
+
+        class Writer {
+        public:
+            Str add(std::string_view str) {
+                Str result{ static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(str.size()) };
+                strings += str;
+                return result;
+            }
+
+            Str add(const std::optional<std::string_view>& str) {
+                return str ? add(*str) : Str{ none, 0 };
+            }
+
+            DescriptionRecord add(const WLDescription& description) {
+                return { add(description.description), add(description.summary) };
+            }
+
+            template<typename Action>
+            Range add(const std::vector<Action>& list) {
+                Range range{ static_cast<std::uint32_t>(actions.size()), static_cast<std::uint32_t>(list.size()) };
+                for (const auto& action : list) {
+                    Range args{ static_cast<std::uint32_t>(arguments.size()), static_cast<std::uint32_t>(action.arguments.size()) };
+                    for (const auto& arg : action.arguments) {
+                        arguments.push_back({ add(arg.name), add(arg.summary), static_cast<std::uint32_t>(arg.type),
+                                              add(arg.arg_enum), add(arg.arg_interface), arg.allow_null });
+                    }
+                    actions.push_back({ add(action.name), add(action.description), action.since, args });
+                }
+                return range;
+            }
+
+            Range add(const std::vector<WLEnum>& list) {
+                Range range{ static_cast<std::uint32_t>(enums.size()), static_cast<std::uint32_t>(list.size()) };
+                for (const auto& wlenum : list) {
+                    Range entry_range{ static_cast<std::uint32_t>(entries.size()), static_cast<std::uint32_t>(wlenum.entries.size()) };
+                    for (const auto& entry : wlenum.entries) {
+                        entries.push_back({ add(entry.name), add(entry.value), add(entry.summary) });
+                    }
+                    auto description = wlenum.description ? add(*wlenum.description) : DescriptionRecord{};
+                    enums.push_back({ add(wlenum.name), wlenum.bitfield, wlenum.description.has_value(), description, entry_range });
+                }
+                return range;
+            }
+
+            void add(const WLInterface& interface) {
+                // Nested lists are added first, interface record keeps only their ranges.
+                auto requests = add(interface.requests);
+                auto events = add(interface.events);
+                auto enum_range = add(interface.enums);
+                interfaces.push_back({ add(interface.name), add(interface.description), interface.version, requests, events, enum_range });
+            }
+
+            template<typename T>
+            static void write(std::ofstream& out, const std::vector<T>& records) {
+                out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+            }
+
+            std::vector<InterfaceRecord> interfaces;
+            std::vector<ActionRecord>    actions;
+            std::vector<ArgumentRecord>  arguments;
+            std::vector<EnumRecord>      enums;
+            std::vector<EntryRecord>     entries;
+            std::string                  strings;
+        };
+
+        // Reads records of validated entry, strings are checked against the pool.
+        class Reader {
+        public:
+            Reader(std::string_view data, const Header& header) : data(data), header(header) {
+                interfaces = sizeof(Header);
+                actions = interfaces + header.interfaces * sizeof(InterfaceRecord);
+                arguments = actions + header.actions * sizeof(ActionRecord);
+                enums = arguments + header.arguments * sizeof(ArgumentRecord);
+                entries = enums + header.enums * sizeof(EnumRecord);
+                strings = entries + header.entries * sizeof(EntryRecord);
+            }
+
+            std::size_t size() const {
+                return strings + header.strings;
+            }
+
+            template<typename T>
+            T record(std::size_t table, std::size_t index) const {
+                T result;
+                std::memcpy(&result, data.data() + table + index * sizeof(T), sizeof(T));
+                return result;
+            }
+
+            std::string_view str(Str str) const {
+                if (std::size_t(str.offset) + str.size > header.strings) {
+                    throw std::out_of_range("string outside of pool");
+                }
+                return data.substr(strings + str.offset, str.size);
+            }
+
+            std::optional<std::string_view> optional(Str value) const {
+                if (value.offset == none) {
+                    return std::nullopt;
+                }
+                return str(value);
+            }
+
+            WLDescription description(const DescriptionRecord& record) const {
+                return { .description = str(record.description), .summary = str(record.summary) };
+            }
+
+            template<typename Action>
+            std::vector<Action> list(Range range) const {
+                check(range, header.actions);
+                std::vector<Action> result(range.count);
+                for (std::uint32_t i = 0; i < range.count; ++i) {
+                    auto action = record<ActionRecord>(actions, range.first + i);
+                    result[i].name = str(action.name);
+                    result[i].description = description(action.description);
+                    result[i].since = action.since;
+                    check(action.arguments, header.arguments);
+                    result[i].arguments.resize(action.arguments.count);
+                    for (std::uint32_t a = 0; a < action.arguments.count; ++a) {
+                        auto arg = record<ArgumentRecord>(arguments, action.arguments.first + a);
+                        auto& argument = result[i].arguments[a];
+                        argument.name = str(arg.name);
+                        argument.summary = str(arg.summary);
+                        argument.type = static_cast<wire_type>(arg.type);
+                        argument.arg_enum = optional(arg.arg_enum);
+                        argument.arg_interface = optional(arg.arg_interface);
+                        argument.allow_null = arg.allow_null != 0;
+                    }
+                }
+                return result;
+            }
+
+            std::vector<WLEnum> enum_list(Range range) const {
+                check(range, header.enums);
+                std::vector<WLEnum> result(range.count);
+                for (std::uint32_t i = 0; i < range.count; ++i) {
+                    auto record_enum = record<EnumRecord>(enums, range.first + i);
+                    auto& wlenum = result[i];
+                    wlenum.name = str(record_enum.name);
+                    wlenum.bitfield = record_enum.bitfield != 0;
+                    if (record_enum.has_description) {
+                        wlenum.description = description(record_enum.description);
+                    }
+                    check(record_enum.entries, header.entries);
+                    wlenum.entries.resize(record_enum.entries.count);
+                    for (std::uint32_t e = 0; e < record_enum.entries.count; ++e) {
+                        auto entry = record<EntryRecord>(entries, record_enum.entries.first + e);
+                        wlenum.entries[e].name = str(entry.name);
+                        wlenum.entries[e].value = str(entry.value);
+                        wlenum.entries[e].summary = optional(entry.summary);
+                    }
+                }
+                return result;
+            }
+
+            WLInterface interface(std::size_t index) const {
+                auto record_interface = record<InterfaceRecord>(interfaces, index);
+                WLInterface interface;
+                interface.name = str(record_interface.name);
+                interface.description = description(record_interface.description);
+                interface.version = record_interface.version;
+                interface.requests = list<WLRequest>(record_interface.requests);
+                interface.events = list<WLEvent>(record_interface.events);
+                interface.enums = enum_list(record_interface.enums);
+                return interface;
+            }
+
+        private:
+            static void check(Range range, std::uint32_t size) {
+                if (std::size_t(range.first) + range.count > size) {
+                    throw std::out_of_range("range outside of table");
+                }
+            }
+
+            std::string_view data;
+            const Header&    header;
+            std::size_t      interfaces, actions, arguments, enums, entries, strings;
+        };
+    }
+
+    ModelCache::ModelCache(std::filesystem::path dir) : dir(std::move(dir)) {
+        std::filesystem::create_directories(this->dir);
+    }
+
+    std::uint64_t ModelCache::key(std::string_view xml) {
+        return Fnv1a().update(xml).update(WAYLANDCPP_GENERATOR_VERSION).update(std::to_string(format_version)).value();
+    }
+
+    std::filesystem::path ModelCache::entry(std::uint64_t key) const {
+        return dir / std::format("{:016x}.wlmodel", key);
+    }
+
+    std::optional<WLProtocol> ModelCache::find(std::uint64_t key) const {
+        auto path = entry(key);
+        if (!std::filesystem::exists(path)) {
+            return std::nullopt;
+        }
+
+        auto mapped = std::make_shared<MappedFile>(path);
+        auto data = mapped->view();
+        Header header;
+        if (data.size() < sizeof(Header)) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data.data(), sizeof(Header));
+        if (header.magic != magic || header.format != format_version || header.key != key) {
+            return std::nullopt;
+        }
+
+        Reader reader(data, header);
+        if (reader.size() != data.size()) {
+            return std::nullopt;
+        }
+
+        try {
+            WLProtocol protocol;
+            protocol.storage = std::make_shared<WLStorage>();
+            protocol.storage->backing = mapped;
+            protocol.name = reader.str(header.name);
+            protocol.interfaces.reserve(header.interfaces);
+            for (std::uint32_t i = 0; i < header.interfaces; ++i) {
+                protocol.interfaces.push_back(reader.interface(i));
+            }
+            return protocol;
+        } catch (const std::out_of_range&) {
+            // Damaged entry is parsed again and overwritten.
+            return std::nullopt;
+        }
+    }
+
+    void ModelCache::store(std::uint64_t key, const WLProtocol& protocol) const {
+        Writer writer;
+        auto name = writer.add(protocol.name);
+        for (const auto& interface : protocol.interfaces) {
+            writer.add(interface);
+        }
+
+        Header header{};
+        header.magic = magic;
+        header.format = format_version;
+        header.key = key;
+        header.name = name;
+        header.interfaces = static_cast<std::uint32_t>(writer.interfaces.size());
+        header.actions = static_cast<std::uint32_t>(writer.actions.size());
+        header.arguments = static_cast<std::uint32_t>(writer.arguments.size());
+        header.enums = static_cast<std::uint32_t>(writer.enums.size());
+        header.entries = static_cast<std::uint32_t>(writer.entries.size());
+        header.strings = static_cast<std::uint32_t>(writer.strings.size());
+
+        auto path = entry(key);
+        auto temporary = path;
+        temporary += std::format(".{}.{}", ::getpid(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream out(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            Writer::write(out, writer.interfaces);
+            Writer::write(out, writer.actions);
+            Writer::write(out, writer.arguments);
+            Writer::write(out, writer.enums);
+            Writer::write(out, writer.entries);
+            out.write(writer.strings.data(), static_cast<std::streamsize>(writer.strings.size()));
+            if (!out) {
+                throw std::runtime_error(std::format("Cannot write model cache '{}'", temporary.string()));
+            }
+        }
+        std::filesystem::rename(temporary, path);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef WAYLAND_GENERATOR_MODELCACHE_H
+#define WAYLAND_GENERATOR_MODELCACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "protocol.hpp"
+
+namespace wayland::generator {
+    /**
+     * Binary copy of parsed protocol models, one file per specification in cache directory.
+     *
+     * File is named by key of the specification: hash of xml content, generator version and cache format,
+     * so changed xml or generator never reads a stale entry. Entry is mapped, its fixed size records are
+     * copied into the model as they are and strings are views into the mapping, nothing is parsed.
+     */
+    class ModelCache {
+    public:
+        explicit ModelCache(std::filesystem::path dir);
+
+        static std::uint64_t key(std::string_view xml);
+
+        // Model stored under key, nullopt if there is none or the entry is damaged.
+        std::optional<WLProtocol> find(std::uint64_t key) const;
+        // Written to temporary file and renamed, so concurrent runs never see partial entry.
+        void store(std::uint64_t key, const WLProtocol& protocol) const;
+
+    private:
+        std::filesystem::path entry(std::uint64_t key) const;
+
+        std::filesystem::path dir;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_MODELCACHE_H */
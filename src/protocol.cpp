@@ -1,6 +1,11 @@
 #include "protocol.hpp"
+#include "mappedfile.hpp"
 #include <iostream>
 #include <format>
+#include <charconv>
+#include <stdexcept>
+
+#include <boost/property_tree/xml_parser.hpp>
 
 namespace wayland::generator {
     template<typename T>
@@ -8,12 +13,17 @@ namespace wayland::generator {
         return node.get<T>(std::string("<xmlattr>.") + name);
     }
 
+    // Value is referenced, not copied, so tree has to outlive the model.
+    static std::string_view get_view(const boost::property_tree::ptree& node, const std::string& name) {
+        return node.get_child("<xmlattr>." + name).data();
+    }
+
     bool prop_exist(const boost::property_tree::ptree& node, std::string&& name) {
         const auto& xml_attr = node.get_child("<xmlattr>");
         return xml_attr.find(name) != xml_attr.not_found();
     }
 
-    static wire_type str_to_wire(std::string type_str) {
+    static wire_type str_to_wire(std::string_view type_str) {
         wire_type type;
         if (type_str == "new_id") {
             type = wire_type::NEW_ID;
@@ -35,16 +45,16 @@ namespace wayland::generator {
             std::cout << "DON'T KNOW WHY THIS TYPE IS DESTRUCTOR IN XML" << std::endl;
             type = wire_type::UINT;
         } else {
-            assert(false);
+            throw std::runtime_error(std::format("Argument type '{}' is unknown", type_str));
         }
         return type;
     }
 
     WLInterface WLInterface::create_from_xml(const boost::property_tree::ptree& description) {
         WLInterface interface;
-        interface.name = get_property<std::string>(description, "name");
+        interface.name = get_view(description, "name");
         interface.version = get_property<int>(description, "version");
-        auto descr_xml = description.get_child("description");
+        const auto& descr_xml = description.get_child("description");
         interface.description = WLDescription::create_from_xml(descr_xml);
         for (const auto& child : description) {
             if (child.first == "request") {
@@ -63,9 +73,60 @@ namespace wayland::generator {
         return interface;
     }
 
+    std::string_view WLStorage::decode(std::string_view raw) {
+        if (raw.find('&') == std::string_view::npos) {
+            return raw;
+        }
+        return keep(xml::decode(raw));
+    }
+
+    std::string_view WLStorage::keep(std::string&& str) {
+        return strings.emplace_back(std::move(str));
+    }
+
+    WLProtocol WLProtocol::load_ptree(const std::filesystem::path& path, Stats::Protocol* stats) {
+        auto tree = std::make_shared<boost::property_tree::ptree>();
+        {
+            Stats::Timer timer(stats ? &stats->xml_load : nullptr);
+            boost::property_tree::read_xml(path.string(), *tree);
+        }
+        Stats::Timer timer(stats ? &stats->model_build : nullptr);
+        auto protocol = create_from_xml(*tree);
+        protocol.storage = std::make_shared<WLStorage>();
+        protocol.storage->backing = tree;
+        return protocol;
+    }
+
+    WLProtocol WLProtocol::load_mapped(const std::filesystem::path& path, Stats::Protocol* stats) {
+        auto storage = std::make_shared<WLStorage>();
+        {
+            Stats::Timer timer(stats ? &stats->xml_load : nullptr);
+            storage->backing = std::make_shared<MappedFile>(path);
+        }
+        Stats::Timer timer(stats ? &stats->model_build : nullptr);
+        xml::Reader reader(std::static_pointer_cast<const MappedFile>(storage->backing)->view());
+        return create_from_xml(reader, storage);
+    }
+
+    WLProtocol WLProtocol::create_from_xml(const boost::property_tree::ptree& document) {
+        WLProtocol protocol;
+        const auto& xml_protocol = document.get_child("protocol");
+        protocol.name = get_view(xml_protocol, "name");
+        for (const auto& child : xml_protocol) {
+            if (child.first == "interface") {
+                protocol.interfaces.push_back(WLInterface::create_from_xml(child.second));
+            }
+        }
+
+        return protocol;
+    }
+
     WLRequest WLRequest::create_from_xml(const boost::property_tree::ptree& description) {
         WLRequest request;
-        request.name = get_property<std::string>(description, "name");
+        request.name = get_view(description, "name");
+        if (prop_exist(description, "since")) {
+            request.since = get_property<int>(description, "since");
+        }
         for (const auto& node : description) {
             if (node.first == WLArgument::xml_name) {
                 request.arguments.push_back(WLArgument::create_from_xml(node.second));
@@ -80,16 +141,23 @@ namespace wayland::generator {
 
     WLArgument WLArgument::create_from_xml(const boost::property_tree::ptree& description) {
         WLArgument argument;
-        argument.name = get_property<std::string>(description, "name");
-        argument.summary = get_property<std::string>(description, "summary");
-        argument.type = str_to_wire(get_property<std::string>(description, "type"));
+        argument.name = get_view(description, "name");
+        // Plenty of arguments in wayland-protocols come without summary.
+        if (prop_exist(description, "summary")) {
+            argument.summary = get_view(description, "summary");
+        }
+        argument.type = str_to_wire(get_view(description, "type"));
 
         if (prop_exist(description, "interface")) {
-            argument.arg_interface = get_property<std::string>(description, "interface");
+            argument.arg_interface = get_view(description, "interface");
         }
 
         if (prop_exist(description, "enum")) {
-            argument.arg_enum = get_property<std::string>(description, "enum");
+            argument.arg_enum = get_view(description, "enum");
+        }
+
+        if (prop_exist(description, "allow-null")) {
+            argument.allow_null = get_property<bool>(description, "allow-null");
         }
 
         return argument;
@@ -98,14 +166,17 @@ namespace wayland::generator {
     WLDescription WLDescription::create_from_xml(const boost::property_tree::ptree& description) {
         return {
             .description = description.data(),
-            .summary = get_property<std::string>(description, "summary"),
+            .summary = get_view(description, "summary"),
         };
     }
 
     WLEvent WLEvent::create_from_xml(const boost::property_tree::ptree& description) {
         WLEvent event;
 
-        event.name = get_property<std::string>(description, "name");
+        event.name = get_view(description, "name");
+        if (prop_exist(description, "since")) {
+            event.since = get_property<int>(description, "since");
+        }
         for (const auto& elems: description) {
             if (elems.first == WLDescription::xml_name) {
                 event.description = WLDescription::create_from_xml(elems.second);
@@ -119,7 +190,7 @@ namespace wayland::generator {
 
     WLEnum WLEnum::create_from_xml(const boost::property_tree::ptree& description) {
         WLEnum wlenum;
-        wlenum.name = get_property<std::string>(description, "name");
+        wlenum.name = get_view(description, "name");
         if (prop_exist(description, "bitfield")) {
             wlenum.bitfield = get_property<bool>(description, "bitfield");
         }
@@ -137,11 +208,255 @@ namespace wayland::generator {
 
     WLEnum::WLEntry WLEnum::WLEntry::create_from_xml(const boost::property_tree::ptree& description) {
         WLEntry entry;
-        entry.name = get_property<std::string>(description, "name");
+        entry.name = get_view(description, "name");
         if (prop_exist(description, "summary")) {
-            entry.summary = get_property<std::string>(description, "summary");
+            entry.summary = get_view(description, "summary");
+        }
+        entry.value = get_view(description, "value");
+
+        return entry;
+    }
+
+    // Streaming frontend.
+    // Every create_from_xml(xml::Reader&) is called with reader standing on START of its element
+    // and returns when END of that element is consumed.
+    static std::optional<std::string_view> get_property(const xml::Reader& reader, WLStorage& storage, std::string_view name) {
+        auto value = reader.attribute(name);
+        if (!value) {
+            return std::nullopt;
+        }
+        return storage.decode(*value);
+    }
+
+    static std::string_view get_required_property(const xml::Reader& reader, WLStorage& storage, std::string_view name) {
+        auto value = get_property(reader, storage, name);
+        if (!value) {
+            throw std::runtime_error(std::format("Element '{}' doesn't have attribute '{}'", reader.name(), name));
+        }
+        return value.value();
+    }
+
+    static std::string_view trim(std::string_view str) {
+        auto begin = str.find_first_not_of(" \t\n\r");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        auto end = str.find_last_not_of(" \t\n\r");
+        return str.substr(begin, end - begin + 1);
+    }
+
+    static int to_int(std::string_view value) {
+        auto str = trim(value);
+        int result = 0;
+        auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), result);
+        if (ec != std::errc() || end != str.data() + str.size()) {
+            throw std::runtime_error(std::format("'{}' is not a number", value));
+        }
+        return result;
+    }
+
+    static bool to_bool(std::string_view value) {
+        auto str = trim(value);
+        if (str == "true" || str == "1") {
+            return true;
+        }
+        if (str == "false" || str == "0") {
+            return false;
+        }
+        throw std::runtime_error(std::format("'{}' is not a boolean", value));
+    }
+
+    // Calls action for every child element, action has to consume child completely.
+    static void for_each_child(xml::Reader& reader, auto&& action) {
+        while (true) {
+            switch (reader.next()) {
+                case xml::token_t::START:
+                    action(reader.name());
+                    break;
+                case xml::token_t::END:
+                    return;
+                case xml::token_t::TEXT:
+                    break;
+                case xml::token_t::END_OF_DOCUMENT:
+                    throw std::runtime_error("Unexpected end of xml document");
+            }
+        }
+    }
+
+    WLProtocol WLProtocol::create_from_xml(xml::Reader& reader, std::shared_ptr<WLStorage> storage_ptr) {
+        auto& storage = *storage_ptr;
+        while (reader.next() != xml::token_t::START) {
+            if (reader.token() == xml::token_t::END_OF_DOCUMENT) {
+                throw std::runtime_error("Xml document is empty");
+            }
+        }
+        if (reader.name() != "protocol") {
+            throw std::runtime_error(std::format("Root element is '{}', expected 'protocol'", reader.name()));
+        }
+
+        WLProtocol protocol;
+        protocol.storage = storage_ptr;
+        protocol.name = get_required_property(reader, storage, "name");
+        for_each_child(reader, [&](auto name) {
+            if (name == "interface") {
+                protocol.interfaces.push_back(WLInterface::create_from_xml(reader, storage));
+            } else {
+                reader.skip();
+            }
+        });
+
+        return protocol;
+    }
+
+    WLInterface WLInterface::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        WLInterface interface;
+        interface.name = get_required_property(reader, storage, "name");
+        interface.version = to_int(get_required_property(reader, storage, "version"));
+        bool has_description = false;
+        for_each_child(reader, [&](auto name) {
+            if (name == WLDescription::xml_name && !has_description) {
+                interface.description = WLDescription::create_from_xml(reader, storage);
+                has_description = true;
+            } else if (name == "request") {
+                interface.requests.push_back(WLRequest::create_from_xml(reader, storage));
+            } else if (name == "event") {
+                interface.events.push_back(WLEvent::create_from_xml(reader, storage));
+            } else if (name == WLEnum::xml_name) {
+                interface.enums.push_back(WLEnum::create_from_xml(reader, storage));
+            } else {
+                reader.skip();
+            }
+        });
+
+        if (!has_description) {
+            throw std::runtime_error(std::format("Interface '{}' doesn't have description", interface.name));
+        }
+
+        return interface;
+    }
+
+    template<typename Action>
+    static Action action_from_xml(xml::Reader& reader, WLStorage& storage) {
+        Action action;
+        action.name = get_required_property(reader, storage, "name");
+        if (auto since = get_property(reader, storage, "since"); since) {
+            action.since = to_int(since.value());
+        }
+        for_each_child(reader, [&](auto name) {
+            if (name == WLArgument::xml_name) {
+                action.arguments.push_back(WLArgument::create_from_xml(reader, storage));
+            } else if (name == WLDescription::xml_name) {
+                action.description = WLDescription::create_from_xml(reader, storage);
+            } else {
+                reader.skip();
+            }
+        });
+
+        return action;
+    }
+
+    WLRequest WLRequest::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        return action_from_xml<WLRequest>(reader, storage);
+    }
+
+    WLEvent WLEvent::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        return action_from_xml<WLEvent>(reader, storage);
+    }
+
+    WLArgument WLArgument::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        WLArgument argument;
+        argument.name = get_required_property(reader, storage, "name");
+        argument.summary = get_property(reader, storage, "summary").value_or(std::string_view());
+        argument.type = str_to_wire(get_required_property(reader, storage, "type"));
+        argument.arg_interface = get_property(reader, storage, "interface");
+        argument.arg_enum = get_property(reader, storage, "enum");
+        if (auto allow_null = get_property(reader, storage, "allow-null"); allow_null) {
+            argument.allow_null = to_bool(allow_null.value());
         }
-        entry.value = get_property<std::string>(description, "value");
+        reader.skip();
+
+        return argument;
+    }
+
+    WLDescription WLDescription::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        WLDescription description;
+        description.summary = get_required_property(reader, storage, "summary");
+        // Same as property tree: concatenated text of the element itself, nested elements are ignored.
+        // Usually there is a single text without entities which is viewed in place.
+        std::optional<std::string_view> single;
+        std::string concatenated;
+        bool copied = false;
+        auto append = [&](std::string_view raw, bool cdata) {
+            if (!copied && !single && (cdata || raw.find('&') == std::string_view::npos)) {
+                single = raw;
+                return;
+            }
+            if (!copied) {
+                copied = true;
+                if (single) {
+                    concatenated.append(single.value());
+                }
+            }
+            if (cdata) {
+                concatenated.append(raw);
+            } else {
+                xml::decode_append(concatenated, raw);
+            }
+        };
+
+        int depth = 1;
+        while (depth > 0) {
+            switch (reader.next()) {
+                case xml::token_t::START:
+                    ++depth;
+                    break;
+                case xml::token_t::END:
+                    --depth;
+                    break;
+                case xml::token_t::TEXT:
+                    if (depth == 1) {
+                        append(reader.text(), reader.cdata());
+                    }
+                    break;
+                case xml::token_t::END_OF_DOCUMENT:
+                    throw std::runtime_error("Unexpected end of xml document");
+            }
+        }
+
+        if (copied) {
+            description.description = storage.keep(std::move(concatenated));
+        } else if (single) {
+            description.description = single.value();
+        }
+
+        return description;
+    }
+
+    WLEnum WLEnum::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        WLEnum wlenum;
+        wlenum.name = get_required_property(reader, storage, "name");
+        if (auto bitfield = get_property(reader, storage, "bitfield"); bitfield) {
+            wlenum.bitfield = to_bool(bitfield.value());
+        }
+        for_each_child(reader, [&](auto name) {
+            if (name == WLDescription::xml_name) {
+                wlenum.description = WLDescription::create_from_xml(reader, storage);
+            } else if (name == WLEntry::xml_name) {
+                wlenum.entries.push_back(WLEntry::create_from_xml(reader, storage));
+            } else {
+                reader.skip();
+            }
+        });
+
+        return wlenum;
+    }
+
+    WLEnum::WLEntry WLEnum::WLEntry::create_from_xml(xml::Reader& reader, WLStorage& storage) {
+        WLEntry entry;
+        entry.name = get_required_property(reader, storage, "name");
+        entry.summary = get_property(reader, storage, "summary");
+        entry.value = get_required_property(reader, storage, "value");
+        reader.skip();
 
         return entry;
     }
@@ -1,12 +1,18 @@
 #ifndef WAYLAND_GENERATOR_PROTOCOL_H
 #define WAYLAND_GENERATOR_PROTOCOL_H
 #include <string>
+#include <string_view>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <optional>
+#include <filesystem>
 
 #include <boost/property_tree/ptree.hpp>
 
 #include "wire_types.hpp"
+#include "xmlreader.hpp"
+#include "stats.hpp"
 
 namespace wayland::generator {
     enum class wire_type {
@@ -20,38 +26,74 @@ namespace wayland::generator {
         FD
     };
 
+    /**
+     * Memory model strings point to.
+     *
+     * Model keeps only views: into mapped xml file, into parsed property tree or into strings owned here.
+     * Own string is created only when value can't be viewed as is, e.g. it contains entities.
+     */
+    class WLStorage {
+    public:
+        // Returns raw if there is nothing to decode, otherwise view of decoded copy.
+        std::string_view decode(std::string_view raw);
+        std::string_view keep(std::string&& str);
+
+        // Object which memory is viewed by the model, e.g. mapped file.
+        std::shared_ptr<const void> backing;
+    private:
+        std::deque<std::string> strings;
+    };
+
     struct WLDescription {
         static constexpr std::string xml_name = "description";
-        std::string description;
-        std::string summary;
+        std::string_view description;
+        std::string_view summary;
         static WLDescription create_from_xml(const boost::property_tree::ptree& description);
+        static WLDescription create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLDescription&) const = default;
     };
 
     struct WLArgument {
         static constexpr std::string xml_name = "arg";
-        std::string name;
-        std::string summary;
+        std::string_view name;
+        std::string_view summary;
         // NOTE: This three values describe one type.
         // Normally we will have only type which is one of the basic types.
         // In case it corresponds to enum the enum will be set, in case it is some object id then interface describing what object is it will be set.
         wire_type type;
-        std::optional<std::string> arg_enum;
-        std::optional<std::string> arg_interface;
+        std::optional<std::string_view> arg_enum;
+        std::optional<std::string_view> arg_interface;
+        // Object, new_id, string and array may be null when set.
+        bool allow_null = false;
         static WLArgument create_from_xml(const boost::property_tree::ptree& description);
+        static WLArgument create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLArgument&) const = default;
     };
 
     struct WLAction {
-        std::string name;
+        std::string_view name;
         WLDescription description;
         std::vector<WLArgument> arguments;
+        // Interface version the message was introduced in.
+        int since = 1;
+
+        bool operator==(const WLAction&) const = default;
     };
 
     struct WLRequest : public WLAction {
         static WLRequest create_from_xml(const boost::property_tree::ptree& description);
+        static WLRequest create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLRequest&) const = default;
     };
 
     struct WLEvent : public WLAction {
         static WLEvent create_from_xml(const boost::property_tree::ptree& description);
+        static WLEvent create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLEvent&) const = default;
     };
 
     struct WLEnum {
@@ -59,22 +101,28 @@ namespace wayland::generator {
 
         struct WLEntry {
             static constexpr std::string xml_name = "entry";
-            std::string name;
-            std::string value;
-            std::optional<std::string> summary;
+            std::string_view name;
+            std::string_view value;
+            std::optional<std::string_view> summary;
             static WLEntry create_from_xml(const boost::property_tree::ptree& description);
+            static WLEntry create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+            bool operator==(const WLEntry&) const = default;
         };
 
-        std::string name;
+        std::string_view name;
         bool bitfield = false;
         std::optional<WLDescription> description;
         std::vector<WLEntry> entries;
         static WLEnum create_from_xml(const boost::property_tree::ptree& description);
+        static WLEnum create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLEnum&) const = default;
     };
 
 
     struct WLInterface {
-        std::string             name;
+        std::string_view        name;
         WLDescription           description;
         std::vector<WLRequest>  requests;
         std::vector<WLEvent>    events;
@@ -82,6 +130,31 @@ namespace wayland::generator {
         int                     version;
 
         static WLInterface create_from_xml(const boost::property_tree::ptree& description);
+        static WLInterface create_from_xml(xml::Reader& reader, WLStorage& storage);
+
+        bool operator==(const WLInterface&) const = default;
+    };
+
+    struct WLProtocol {
+        std::string_view         name;
+        std::vector<WLInterface> interfaces;
+        // Shared so protocol can be copied, views stay valid while any copy is alive.
+        std::shared_ptr<WLStorage> storage;
+
+        // Takes whole xml document, <protocol> is expected to be its root element.
+        // Tree has to outlive the model, keep it in storage backing.
+        static WLProtocol create_from_xml(const boost::property_tree::ptree& document);
+        // Reader is expected to be at the beginning of the document.
+        static WLProtocol create_from_xml(xml::Reader& reader, std::shared_ptr<WLStorage> storage);
+
+        // Parses xml with property tree, strings are views into the tree.
+        static WLProtocol load_ptree(const std::filesystem::path& path, Stats::Protocol* stats = nullptr);
+        // Maps the file and parses it with streaming parser, strings are views into the mapping.
+        static WLProtocol load_mapped(const std::filesystem::path& path, Stats::Protocol* stats = nullptr);
+
+        bool operator==(const WLProtocol& other) const {
+            return name == other.name && interfaces == other.interfaces;
+        }
     };
 }
 
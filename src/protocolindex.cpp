@@ -0,0 +1,105 @@
+#include "protocolindex.hpp"
+#include "mappedfile.hpp"
+#include "xmlreader.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace wayland::generator {
+    // Start or end tag of the element: name followed by space, '/' or '>'.
+    static bool is_tag(std::string_view markup, std::string_view prefix) {
+        if (!markup.starts_with(prefix) || markup.size() == prefix.size()) {
+            return false;
+        }
+        auto next = markup[prefix.size()];
+        return next == ' ' || next == '\t' || next == '\r' || next == '\n' || next == '/' || next == '>';
+    }
+
+    // Position of the next '<' of a tag, comments and CDATA sections are passed over. npos at the end of document.
+    static std::size_t next_tag(std::string_view xml, std::size_t position) {
+        while ((position = xml.find('<', position)) != std::string_view::npos) {
+            auto markup = xml.substr(position);
+            std::string_view terminator;
+            if (markup.starts_with("<!--")) {
+                terminator = "-->";
+            } else if (markup.starts_with("<![CDATA[")) {
+                terminator = "]]>";
+            } else {
+                return position;
+            }
+            position = xml.find(terminator, position);
+            if (position == std::string_view::npos) {
+                return position;
+            }
+            position += terminator.size();
+        }
+        return position;
+    }
+
+    ProtocolIndex::ProtocolIndex(const std::filesystem::path& path, Stats::Protocol* stats)
+        : path(path), storage(std::make_shared<WLStorage>()) {
+        Stats::Timer timer(stats ? &stats->xml_load : nullptr);
+        storage->backing = std::make_shared<MappedFile>(path);
+        auto xml = document();
+
+        // Prolog and root tag are read by the reader, it knows declarations and doctype.
+        xml::Reader root(xml);
+        while (root.next() != xml::token_t::START) {
+            if (root.token() == xml::token_t::END_OF_DOCUMENT) {
+                throw std::runtime_error(std::format("{}: Xml document is empty", path.string()));
+            }
+        }
+        if (root.name() != "protocol") {
+            throw std::runtime_error(std::format("{}: Root element is '{}', expected 'protocol'", path.string(), root.name()));
+        }
+        auto name = root.attribute("name");
+        if (!name) {
+            throw std::runtime_error(std::format("{}: Property 'name' of 'protocol' is missing", path.string()));
+        }
+        name_ = storage->decode(name.value());
+
+        for (auto position = next_tag(xml, root.offset()); position != std::string_view::npos; position = next_tag(xml, position)) {
+            auto markup = xml.substr(position);
+            if (!is_tag(markup, "<interface")) {
+                ++position;
+                continue;
+            }
+
+            xml::Reader tag(markup);
+            tag.next();
+            auto interface_name = tag.attribute("name");
+            if (!interface_name) {
+                throw std::runtime_error(std::format("{}: Property 'name' of 'interface' is missing", path.string()));
+            }
+            Entry entry{ storage->decode(interface_name.value()), position, position + tag.offset() };
+            // Self closing element ends with its start tag.
+            if (xml[entry.end - 2] != '/') {
+                auto close = next_tag(xml, entry.end);
+                while (close != std::string_view::npos && !is_tag(xml.substr(close), "</interface")) {
+                    close = next_tag(xml, close + 1);
+                }
+                auto end = close == std::string_view::npos ? close : xml.find('>', close);
+                if (end == std::string_view::npos) {
+                    throw std::runtime_error(std::format("{}: Interface '{}' is not closed", path.string(), entry.name));
+                }
+                entry.end = end + 1;
+            }
+            entries.push_back(entry);
+            position = entry.end;
+        }
+    }
+
+    WLInterface ProtocolIndex::parse(const Entry& entry) const {
+        xml::Reader reader(document().substr(entry.begin, entry.end - entry.begin));
+        reader.next();
+        try {
+            return WLInterface::create_from_xml(reader, *storage);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::format("{}: interface '{}': {}", path.string(), entry.name, e.what()));
+        }
+    }
+
+    std::string_view ProtocolIndex::document() const {
+        return std::static_pointer_cast<const MappedFile>(storage->backing)->view();
+    }
+}
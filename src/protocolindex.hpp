@@ -0,0 +1,49 @@
+#ifndef WAYLAND_GENERATOR_PROTOCOLINDEX_H
+#define WAYLAND_GENERATOR_PROTOCOLINDEX_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "protocol.hpp"
+#include "stats.hpp"
+
+namespace wayland::generator {
+    /**
+     * Name and byte range of every interface of mapped specification.
+     *
+     * Scan reads only tags of <protocol> children: content of an interface is passed over looking for '<' of its end tag,
+     * comments and CDATA sections are skipped, nothing is decoded or allocated per element.
+     * Interfaces are parsed one by one afterwards, only those which are needed.
+     */
+    class ProtocolIndex {
+    public:
+        struct Entry {
+            std::string_view name;
+            // Range of the element in the document, from '<' of start tag to '>' of end tag inclusive.
+            std::size_t      begin = 0;
+            std::size_t      end = 0;
+        };
+
+        // Scan is counted as xml_load of stats.
+        explicit ProtocolIndex(const std::filesystem::path& path, Stats::Protocol* stats = nullptr);
+
+        std::string_view name() const { return name_; }
+        const std::vector<Entry>& interfaces() const { return entries; }
+
+        // Parses the whole element of entry, strings are views into the mapping, index has to outlive the interface.
+        // Not thread safe, one index is parsed by one job.
+        WLInterface parse(const Entry& entry) const;
+    private:
+        std::string_view document() const;
+
+        std::filesystem::path      path;
+        std::shared_ptr<WLStorage> storage;
+        std::string_view           name_;
+        std::vector<Entry>         entries;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_PROTOCOLINDEX_H */
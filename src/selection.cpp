@@ -0,0 +1,45 @@
+#include "selection.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace wayland::generator {
+    InterfaceSet interface_closure(const std::vector<std::string>& roots, const InterfaceLookup& lookup) {
+        InterfaceSet reached;
+        std::vector<const WLInterface*> pending;
+        for (const auto& root : roots) {
+            if (reached.contains(root)) {
+                continue;
+            }
+            auto interface = lookup(root);
+            if (!interface) {
+                throw std::runtime_error(std::format("Interface '{}' is not found!", root));
+            }
+            reached.insert(root);
+            pending.push_back(interface);
+        }
+
+        auto follow = [&](const WLAction& action) {
+            for (const auto& argument : action.arguments) {
+                if (!argument.arg_interface || reached.contains(argument.arg_interface.value())) {
+                    continue;
+                }
+                if (auto interface = lookup(argument.arg_interface.value())) {
+                    reached.emplace(argument.arg_interface.value());
+                    pending.push_back(interface);
+                }
+            }
+        };
+        while (!pending.empty()) {
+            auto interface = pending.back();
+            pending.pop_back();
+            for (const auto& request : interface->requests) {
+                follow(request);
+            }
+            for (const auto& event : interface->events) {
+                follow(event);
+            }
+        }
+        return reached;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef WAYLAND_GENERATOR_SELECTION_H
+#define WAYLAND_GENERATOR_SELECTION_H
+
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "protocol.hpp"
+
+namespace wayland::generator {
+    using InterfaceSet = std::set<std::string, std::less<>>;
+    // Model of interface by name, nullptr if no given specification has it.
+    using InterfaceLookup = std::function<const WLInterface*(std::string_view)>;
+
+    /**
+     * Roots and every interface reachable from them through interface attribute of object and new_id arguments.
+     *
+     * Unknown root is an error, unknown referenced interface is skipped: it belongs to specification
+     * which wasn't given, e.g. wl_surface of xdg_surface when only xdg-shell is generated.
+     */
+    InterfaceSet interface_closure(const std::vector<std::string>& roots, const InterfaceLookup& lookup);
+}
+
+#endif /* WAYLAND_GENERATOR_SELECTION_H */
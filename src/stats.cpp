@@ -0,0 +1,118 @@
+#include "stats.hpp"
+
+#include <format>
+#include <string>
+
+#include <sys/resource.h>
+
+namespace wayland::generator {
+    std::atomic<bool>        Stats::counting = false;
+    std::atomic<std::size_t> Stats::allocations = 0;
+    std::atomic<std::size_t> Stats::allocated_bytes = 0;
+
+    static double to_ms(Stats::clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    static std::string json_string(std::string_view value) {
+        std::string result = "\"";
+        for (char c : value) {
+            switch (c) {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        result += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                    } else {
+                        result += c;
+                    }
+            }
+        }
+        return result + "\"";
+    }
+
+    static std::size_t peak_rss_bytes() {
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+        // Linux reports kilobytes.
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    }
+
+    Stats::Stats(std::size_t jobs) : jobs(jobs), start(clock::now()) {
+        allocations = 0;
+        allocated_bytes = 0;
+        counting = true;
+    }
+
+    Stats::~Stats() {
+        counting = false;
+    }
+
+    void Stats::write_json(std::ostream& out) const {
+        auto total = clock::now() - start;
+        auto allocation_count = allocations.load();
+        auto allocation_bytes = allocated_bytes.load();
+
+        clock::duration xml_load{}, model_build{}, ast_build{}, format{}, write{};
+        for (const auto& protocol : protocols) {
+            xml_load += protocol.xml_load;
+            model_build += protocol.model_build;
+        }
+
+        std::size_t written = 0, skipped = 0, bytes_written = 0, bytes_skipped = 0;
+        for (const auto& interface : interfaces) {
+            ast_build += interface.ast_build;
+            format += interface.format;
+            write += interface.write;
+            if (interface.written) {
+                ++written;
+                bytes_written += interface.bytes;
+            } else {
+                ++skipped;
+                bytes_skipped += interface.bytes;
+            }
+        }
+
+        out << "{\n";
+        out << std::format("  \"wall_ms\": {:.3f},\n", to_ms(total));
+        out << std::format("  \"jobs\": {},\n", jobs);
+        out << "  \"phases_ms\": {\n";
+        out << std::format("    \"xml_load\": {:.3f},\n", to_ms(xml_load));
+        out << std::format("    \"model_build\": {:.3f},\n", to_ms(model_build));
+        out << std::format("    \"ast_build\": {:.3f},\n", to_ms(ast_build));
+        out << std::format("    \"format\": {:.3f},\n", to_ms(format));
+        out << std::format("    \"write\": {:.3f}\n", to_ms(write));
+        out << "  },\n";
+        out << std::format("  \"allocations\": {{ \"count\": {}, \"bytes\": {} }},\n", allocation_count, allocation_bytes);
+        out << std::format("  \"peak_rss_bytes\": {},\n", peak_rss_bytes());
+        out << std::format("  \"files\": {{ \"written\": {}, \"skipped\": {}, \"bytes_written\": {}, \"bytes_skipped\": {} }},\n",
+                           written, skipped, bytes_written, bytes_skipped);
+
+        out << "  \"protocols\": [";
+        for (std::size_t i = 0; i < protocols.size(); ++i) {
+            const auto& protocol = protocols[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << std::format("    {{ \"name\": {}, \"config\": {}, \"xml_load_ms\": {:.3f}, \"model_build_ms\": {:.3f}, \"cached\": {} }}",
+                               json_string(protocol.name), json_string(protocol.config.string()),
+                               to_ms(protocol.xml_load), to_ms(protocol.model_build), protocol.cached);
+        }
+        out << (protocols.empty() ? "],\n" : "\n  ],\n");
+
+        out << "  \"interfaces\": [";
+        for (std::size_t i = 0; i < interfaces.size(); ++i) {
+            const auto& interface = interfaces[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << std::format("    {{ \"protocol\": {}, \"name\": {}, \"header\": {}, \"ast_build_ms\": {:.3f}, \"format_ms\": {:.3f}, "
+                               "\"write_ms\": {:.3f}, \"bytes\": {}, \"written\": {} }}",
+                               json_string(interface.protocol), json_string(interface.name), json_string(interface.header.string()),
+                               to_ms(interface.ast_build), to_ms(interface.format), to_ms(interface.write),
+                               interface.bytes, interface.written);
+        }
+        out << (interfaces.empty() ? "]\n" : "\n  ]\n");
+        out << "}" << std::endl;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef WAYLAND_GENERATOR_STATS_H
+#define WAYLAND_GENERATOR_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wayland::generator {
+    /**
+     * Instrumentation behind --stats, printed as JSON.
+     *
+     * Phase times are sums of protocol and interface times, with --jobs 1 they add up to wall time.
+     * Every protocol and interface has its own slot, so jobs fill them without locking.
+     */
+    class Stats {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        // Names are copied, with --stream models are released before the report is written.
+        struct Protocol {
+            std::string           name;
+            std::filesystem::path config;
+            clock::duration       xml_load{};
+            clock::duration       model_build{};
+            // Model was loaded from --cache-dir, xml_load is hashing of the xml then.
+            bool                  cached = false;
+        };
+
+        struct Interface {
+            std::string           protocol;
+            std::string           name;
+            std::filesystem::path header;
+            clock::duration       ast_build{};
+            clock::duration       format{};
+            clock::duration       write{};
+            std::size_t           bytes = 0;
+            bool                  written = false;
+        };
+
+        // Adds time of its scope to target, does nothing without target.
+        class Timer {
+        public:
+            explicit Timer(clock::duration* target) : target(target), start(clock::now()) {}
+            ~Timer() {
+                if (target) {
+                    *target += clock::now() - start;
+                }
+            }
+
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+        private:
+            clock::duration*  target;
+            clock::time_point start;
+        };
+
+        // Starts wall clock and allocation counting.
+        explicit Stats(std::size_t jobs);
+        ~Stats();
+
+        Stats(const Stats&) = delete;
+        Stats& operator=(const Stats&) = delete;
+
+        std::vector<Protocol>  protocols;
+        std::vector<Interface> interfaces;
+
+        // Called from replaced global operator new, see allocation_counter.cpp.
+        static void count_allocation(std::size_t size) {
+            if (counting.load(std::memory_order_relaxed)) {
+                allocations.fetch_add(1, std::memory_order_relaxed);
+                allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+            }
+        }
+
+        void write_json(std::ostream& out) const;
+    private:
+        static std::atomic<bool>        counting;
+        static std::atomic<std::size_t> allocations;
+        static std::atomic<std::size_t> allocated_bytes;
+
+        std::size_t       jobs;
+        clock::time_point start;
+    };
+}
+
+#endif /* WAYLAND_GENERATOR_STATS_H */
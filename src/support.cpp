@@ -0,0 +1,240 @@
+#include "support.hpp"
+
+namespace wayland::generator {
+    std::string_view outgoing_buffer_source() {
+        return R"(#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace waylandcpp::wire {
+    /**
+     * Outgoing requests of one connection.
+     *
+     * Requests are copied into the buffer and sent with one sendmsg when flush() is called,
+     * when the next request doesn't fit, or by the connection before it blocks waiting for events.
+     * File descriptors are queued before the request they belong to and leave as SCM_RIGHTS
+     * with the next sendmsg, so they never arrive after their request.
+     * Socket is expected to be blocking.
+     */
+    class OutgoingBuffer {
+    public:
+        // Same as connection buffer of libwayland.
+        static constexpr std::size_t capacity = 4096;
+        // Same as limit of libwayland for one sendmsg.
+        static constexpr std::size_t max_fds = 28;
+
+        explicit OutgoingBuffer(int fd) : fd(fd) {}
+        ~OutgoingBuffer() {
+            close_fds();
+        }
+
+        OutgoingBuffer(const OutgoingBuffer&) = delete;
+        OutgoingBuffer& operator=(const OutgoingBuffer&) = delete;
+
+        // Descriptor is duplicated, caller keeps ownership of its own one. The duplicate is closed once sent.
+        // Throws std::length_error when max_fds descriptors are queued and no buffered request can carry them.
+        void queue_fd(int descriptor) {
+            // Queued descriptors belong to already buffered requests, send them together.
+            if (fd_count == max_fds) {
+                flush();
+            }
+            // Nothing was buffered, so all of them belong to the request being written, more than one sendmsg can carry.
+            if (fd_count == max_fds) {
+                throw std::length_error("too many fds queued for one request");
+            }
+            auto duplicate = ::fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+            if (duplicate < 0) {
+                throw std::system_error(errno, std::generic_category(), "fcntl");
+            }
+            fds[fd_count++] = duplicate;
+        }
+
+        void queue(const void* data, std::size_t size) {
+            if (used + size <= capacity) {
+                std::memcpy(buffer.data() + used, data, size);
+                used += size;
+                return;
+            }
+            // Buffered requests and the new one leave in the same syscall.
+            iovec iov[2] = { { buffer.data(), used }, { const_cast<void*>(data), size } };
+            send(iov, 2);
+            used = 0;
+        }
+
+        void flush() {
+            if (used == 0) {
+                return;
+            }
+            iovec iov[1] = { { buffer.data(), used } };
+            send(iov, 1);
+            used = 0;
+        }
+
+        std::size_t size() const {
+            return used;
+        }
+
+        std::size_t fd_size() const {
+            return fd_count;
+        }
+
+    private:
+        void send(iovec* iov, std::size_t count) {
+            while (count > 0) {
+                msghdr msg{};
+                msg.msg_iov = iov;
+                msg.msg_iovlen = count;
+                // Descriptors go with the first part of data which is actually sent.
+                alignas(cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * max_fds)> control;
+                if (fd_count > 0) {
+                    msg.msg_control = control.data();
+                    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+                    auto cmsg = CMSG_FIRSTHDR(&msg);
+                    cmsg->cmsg_level = SOL_SOCKET;
+                    cmsg->cmsg_type = SCM_RIGHTS;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+                    std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fd_count);
+                }
+                auto sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+                if (sent < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "sendmsg");
+                }
+                close_fds();
+                // Drop sent vectors, the partially sent one continues from where it stopped.
+                auto left = static_cast<std::size_t>(sent);
+                while (count > 0 && left >= iov->iov_len) {
+                    left -= iov->iov_len;
+                    ++iov;
+                    --count;
+                }
+                if (count > 0) {
+                    iov->iov_base = static_cast<std::byte*>(iov->iov_base) + left;
+                    iov->iov_len -= left;
+                }
+            }
+        }
+
+        void close_fds() {
+            for (std::size_t i = 0; i < fd_count; ++i) {
+                ::close(fds[i]);
+            }
+            fd_count = 0;
+        }
+
+        int                                fd;
+        std::array<std::byte, capacity>    buffer;
+        std::size_t                        used = 0;
+        std::array<int, max_fds>           fds;
+        std::size_t                        fd_count = 0;
+    };
+}
+)";
+    }
+
+    std::string_view fd_ring_source() {
+        return R"(#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace waylandcpp::wire {
+    /**
+     * File descriptors received by one connection, in order of arrival.
+     *
+     * Connection pushes descriptors of every recvmsg with receive(), events with fd arguments
+     * pop them during dispatch and own them afterwards. Descriptors left in the ring are closed with it.
+     */
+    class FdRing {
+    public:
+        // Same as fd buffer of libwayland connection, power of two.
+        static constexpr std::size_t capacity = 1024;
+
+        FdRing() = default;
+        ~FdRing() {
+            while (count > 0) {
+                ::close(pop());
+            }
+        }
+
+        FdRing(const FdRing&) = delete;
+        FdRing& operator=(const FdRing&) = delete;
+
+        // Takes descriptors of SCM_RIGHTS control messages, msg is filled by recvmsg.
+        void receive(const msghdr& msg) {
+            for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+                    continue;
+                }
+                auto received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (std::size_t i = 0; i < received; ++i) {
+                    int descriptor;
+                    std::memcpy(&descriptor, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                    push(descriptor);
+                }
+            }
+        }
+
+        void push(int descriptor) {
+            if (count == capacity) {
+                ::close(descriptor);
+                throw std::length_error("fd ring is full");
+            }
+            ring[(head + count++) & (capacity - 1)] = descriptor;
+        }
+
+        // Next descriptor of the message being dispatched, missing one is protocol error.
+        int pop() {
+            if (count == 0) {
+                throw std::runtime_error("event expects fd which wasn't received");
+            }
+            auto descriptor = ring[head];
+            head = (head + 1) & (capacity - 1);
+            --count;
+            return descriptor;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+    private:
+        std::array<int, capacity> ring;
+        std::size_t               head = 0;
+        std::size_t               count = 0;
+    };
+}
+)";
+    }
+
+    std::string_view metadata_source() {
+        return R"(#include <string_view>
+
+namespace waylandcpp::wire {
+    /**
+     * Static description of a request or event, same as wl_message of libwayland.
+     *
+     * Signature starts with the interface version the message was introduced in when above 1,
+     * followed by a type code per argument: i int, u uint, f fixed, s string, o object, n new_id,
+     * a array, h fd. Nullable arguments are prefixed by '?'. new_id without interface is "sun".
+     * Every interface has request_metadata and event_metadata indexed by opcode.
+     */
+    struct MessageMetadata {
+        std::string_view name;
+        std::string_view signature;
+    };
+}
+)";
+    }
+}
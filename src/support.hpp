@@ -0,0 +1,19 @@
+#ifndef WAYLAND_GENERATOR_SUPPORT_H
+#define WAYLAND_GENERATOR_SUPPORT_H
+
+#include <string_view>
+
+namespace wayland::generator {
+    // Sources of headers generated next to interfaces, they don't depend on protocol.
+
+    // waylandcpp/wire/outgoing_buffer.hpp, used by --corked requests through the socket.
+    std::string_view outgoing_buffer_source();
+
+    // waylandcpp/wire/fd_ring.hpp, received descriptors popped by events with --fd-queue.
+    std::string_view fd_ring_source();
+
+    // waylandcpp/wire/metadata.hpp, type of static message tables of every interface.
+    std::string_view metadata_source();
+}
+
+#endif /* WAYLAND_GENERATOR_SUPPORT_H */
@@ -0,0 +1,119 @@
+#include "threadpool.hpp"
+
+namespace wayland::generator {
+    ThreadPool::ThreadPool(std::size_t jobs) {
+        if (jobs == 0) {
+            jobs = default_jobs();
+        }
+
+        for (std::size_t i = 0; i < jobs; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+
+        for (std::size_t i = 0; i < jobs; ++i) {
+            threads.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard guard(state_lock);
+            stopping = true;
+        }
+        work_cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::size_t ThreadPool::default_jobs() {
+        auto hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    void ThreadPool::submit(task_t task) {
+        std::size_t target;
+        {
+            std::lock_guard guard(state_lock);
+            target = next_worker++ % workers.size();
+            ++pending;
+            ++queued;
+        }
+        {
+            std::lock_guard guard(workers[target]->lock);
+            workers[target]->tasks.push_back(std::move(task));
+        }
+        work_cv.notify_one();
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock guard(state_lock);
+        done_cv.wait(guard, [this] { return pending == 0; });
+        if (first_error) {
+            auto error = first_error;
+            first_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool ThreadPool::pop_own(std::size_t self, task_t& task) {
+        auto& worker = *workers[self];
+        std::lock_guard guard(worker.lock);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool ThreadPool::steal(std::size_t self, task_t& task) {
+        for (std::size_t i = 1; i < workers.size(); ++i) {
+            auto& victim = *workers[(self + i) % workers.size()];
+            std::lock_guard guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::finish_task(std::exception_ptr error) {
+        std::lock_guard guard(state_lock);
+        if (error && !first_error) {
+            first_error = error;
+        }
+        if (--pending == 0) {
+            done_cv.notify_all();
+        }
+    }
+
+    void ThreadPool::run(std::size_t self) {
+        while (true) {
+            {
+                std::unique_lock guard(state_lock);
+                work_cv.wait(guard, [this] { return stopping || queued > 0; });
+                if (queued == 0) {
+                    return;
+                }
+                --queued;
+            }
+
+            // Task reserved above is guaranteed to be in one of the deques.
+            task_t task;
+            while (!pop_own(self, task) && !steal(self, task)) {
+                std::this_thread::yield();
+            }
+
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finish_task(error);
+        }
+    }
+}
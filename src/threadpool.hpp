@@ -0,0 +1,80 @@
+#ifndef WAYLAND_GENERATOR_THREADPOOL_H
+#define WAYLAND_GENERATOR_THREADPOOL_H
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace wayland::generator {
+    /**
+     * Work-stealing pool of generator jobs.
+     *
+     * Each worker owns a deque: it takes its own tasks from the back and, once empty,
+     * steals from the front of the other workers' deques. Tasks are distributed round robin on submit.
+     * First exception thrown by a task is rethrown from wait().
+     */
+    class ThreadPool {
+    public:
+        using task_t = std::function<void()>;
+
+        explicit ThreadPool(std::size_t jobs);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(task_t task);
+        void wait();
+
+        std::size_t size() const { return workers.size(); }
+
+        // Number of jobs to use when user asked for 0 (auto).
+        static std::size_t default_jobs();
+    private:
+        struct Worker {
+            std::mutex          lock;
+            std::deque<task_t>  tasks;
+        };
+
+        bool pop_own(std::size_t self, task_t& task);
+        bool steal(std::size_t self, task_t& task);
+        void run(std::size_t self);
+        void finish_task(std::exception_ptr error);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread>             threads;
+
+        std::mutex              state_lock;
+        std::condition_variable work_cv;
+        std::condition_variable done_cv;
+        std::size_t             queued = 0;
+        std::size_t             pending = 0;
+        std::size_t             next_worker = 0;
+        bool                    stopping = false;
+        std::exception_ptr      first_error;
+    };
+
+    // Applies function to every element of range, serially when there is no pool.
+    template<typename Range, typename Function>
+    void for_each_job(ThreadPool* pool, Range& range, Function function) {
+        if (!pool) {
+            for (auto& element : range) {
+                function(element);
+            }
+            return;
+        }
+
+        for (auto& element : range) {
+            pool->submit([&function, &element] { function(element); });
+        }
+        pool->wait();
+    }
+}
+
+#endif /* WAYLAND_GENERATOR_THREADPOOL_H */
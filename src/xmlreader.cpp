@@ -0,0 +1,265 @@
+#include "xmlreader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <stdexcept>
+
+namespace wayland::generator::xml {
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static bool is_name_end(char c) {
+        return is_space(c) || c == '/' || c == '>' || c == '=';
+    }
+
+    std::optional<std::string_view> Reader::attribute(std::string_view name) const {
+        for (const auto& attribute : attributes_) {
+            if (attribute.name == name) {
+                return attribute.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void Reader::error(const std::string& message) const {
+        auto end = document.begin() + std::min(position, document.size());
+        auto line = std::count(document.begin(), end, '\n') + 1;
+        throw std::runtime_error(std::format("XML error at line {}: {}", line, message));
+    }
+
+    void Reader::skip_past(std::string_view terminator) {
+        auto end = document.find(terminator, position);
+        if (end == std::string_view::npos) {
+            error(std::format("missing '{}'", terminator));
+        }
+        position = end + terminator.size();
+    }
+
+    void Reader::skip_spaces() {
+        while (position < document.size() && is_space(document[position])) {
+            ++position;
+        }
+    }
+
+    std::string_view Reader::read_name() {
+        auto start = position;
+        while (position < document.size() && !is_name_end(document[position])) {
+            ++position;
+        }
+        if (start == position) {
+            error("expected name");
+        }
+        return document.substr(start, position - start);
+    }
+
+    void Reader::read_start_tag() {
+        // Skip '<'
+        ++position;
+        name_ = read_name();
+        attributes_.clear();
+
+        while (true) {
+            skip_spaces();
+            if (position >= document.size()) {
+                error(std::format("unterminated element '{}'", name_));
+            }
+
+            if (document[position] == '>') {
+                ++position;
+                open_elements.push_back(name_);
+                return;
+            }
+
+            if (document.substr(position, 2) == "/>") {
+                position += 2;
+                pending_end = true;
+                return;
+            }
+
+            auto attribute_name = read_name();
+            skip_spaces();
+            if (position >= document.size() || document[position] != '=') {
+                error(std::format("attribute '{}' has no value", attribute_name));
+            }
+            ++position;
+            skip_spaces();
+            if (position >= document.size() || (document[position] != '"' && document[position] != '\'')) {
+                error(std::format("value of attribute '{}' is not quoted", attribute_name));
+            }
+            auto quote = document[position++];
+            auto end = document.find(quote, position);
+            if (end == std::string_view::npos) {
+                error(std::format("unterminated value of attribute '{}'", attribute_name));
+            }
+            attributes_.push_back({ attribute_name, document.substr(position, end - position) });
+            position = end + 1;
+        }
+    }
+
+    void Reader::read_end_tag() {
+        // Skip '</'
+        position += 2;
+        name_ = read_name();
+        skip_spaces();
+        if (position >= document.size() || document[position] != '>') {
+            error(std::format("unterminated closing tag '{}'", name_));
+        }
+        ++position;
+
+        if (open_elements.empty() || open_elements.back() != name_) {
+            error(std::format("unexpected closing tag '{}'", name_));
+        }
+        open_elements.pop_back();
+    }
+
+    token_t Reader::next() {
+        if (pending_end) {
+            pending_end = false;
+            return token_ = token_t::END;
+        }
+
+        while (position < document.size()) {
+            auto rest = document.substr(position);
+            if (rest[0] != '<') {
+                auto end = document.find('<', position);
+                if (end == std::string_view::npos) {
+                    end = document.size();
+                }
+                text_ = document.substr(position, end - position);
+                cdata_ = false;
+                position = end;
+                return token_ = token_t::TEXT;
+            }
+
+            if (rest.starts_with("<?")) {
+                skip_past("?>");
+            } else if (rest.starts_with("<!--")) {
+                skip_past("-->");
+            } else if (rest.starts_with("<![CDATA[")) {
+                position += 9;
+                auto end = document.find("]]>", position);
+                if (end == std::string_view::npos) {
+                    error("unterminated CDATA section");
+                }
+                text_ = document.substr(position, end - position);
+                cdata_ = true;
+                position = end + 3;
+                return token_ = token_t::TEXT;
+            } else if (rest.starts_with("<!")) {
+                // DOCTYPE, internal subset may contain '>' inside of brackets.
+                auto bracket = document.find_first_of("[>", position);
+                if (bracket != std::string_view::npos && document[bracket] == '[') {
+                    position = bracket;
+                    skip_past("]");
+                }
+                skip_past(">");
+            } else if (rest.starts_with("</")) {
+                read_end_tag();
+                return token_ = token_t::END;
+            } else {
+                read_start_tag();
+                return token_ = token_t::START;
+            }
+        }
+
+        if (!open_elements.empty()) {
+            error(std::format("element '{}' is not closed", open_elements.back()));
+        }
+        return token_ = token_t::END_OF_DOCUMENT;
+    }
+
+    void Reader::skip() {
+        int depth = 1;
+        while (depth > 0) {
+            switch (next()) {
+                case token_t::START:
+                    ++depth;
+                    break;
+                case token_t::END:
+                    --depth;
+                    break;
+                case token_t::TEXT:
+                    break;
+                case token_t::END_OF_DOCUMENT:
+                    error("unexpected end of document");
+            }
+        }
+    }
+
+    static void append_utf8(std::string& out, unsigned long code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // Returns false if entity is not known, in that case it is kept in output as is.
+    static bool decode_entity(std::string& out, std::string_view entity) {
+        if (entity == "lt") {
+            out += '<';
+        } else if (entity == "gt") {
+            out += '>';
+        } else if (entity == "amp") {
+            out += '&';
+        } else if (entity == "quot") {
+            out += '"';
+        } else if (entity == "apos") {
+            out += '\'';
+        } else if (entity.size() > 1 && entity[0] == '#') {
+            int base = 10;
+            entity.remove_prefix(1);
+            if (entity[0] == 'x') {
+                base = 16;
+                entity.remove_prefix(1);
+            }
+            unsigned long code = 0;
+            auto [end, ec] = std::from_chars(entity.data(), entity.data() + entity.size(), code, base);
+            if (ec != std::errc() || end != entity.data() + entity.size() || code > 0x10FFFF) {
+                return false;
+            }
+            append_utf8(out, code);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void decode_append(std::string& out, std::string_view raw) {
+        while (!raw.empty()) {
+            auto amp = raw.find('&');
+            out.append(raw.substr(0, amp));
+            if (amp == std::string_view::npos) {
+                return;
+            }
+            raw.remove_prefix(amp);
+
+            auto semicolon = raw.find(';');
+            if (semicolon == std::string_view::npos || !decode_entity(out, raw.substr(1, semicolon - 1))) {
+                out += '&';
+                raw.remove_prefix(1);
+                continue;
+            }
+            raw.remove_prefix(semicolon + 1);
+        }
+    }
+
+    std::string decode(std::string_view raw) {
+        std::string out;
+        out.reserve(raw.size());
+        decode_append(out, raw);
+        return out;
+    }
+}
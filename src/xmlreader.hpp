@@ -0,0 +1,76 @@
+#ifndef WAYLAND_GENERATOR_XMLREADER_H
+#define WAYLAND_GENERATOR_XMLREADER_H
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstddef>
+
+namespace wayland::generator::xml {
+    enum class token_t {
+        START,
+        END,
+        TEXT,
+        END_OF_DOCUMENT
+    };
+
+    struct Attribute {
+        std::string_view name;
+        // Raw value, entities are not decoded.
+        std::string_view value;
+    };
+
+    /**
+     * Pull parser over in memory xml document.
+     *
+     * Doesn't build any tree and doesn't allocate per token: names, attributes and text are views into the document.
+     * Self closing element is reported as START followed by END.
+     * Processing instructions, comments and doctype are skipped.
+     * Malformed document results in runtime_error with line number.
+     */
+    class Reader {
+    public:
+        explicit Reader(std::string_view document) : document(document) {}
+
+        token_t next();
+
+        token_t token() const { return token_; }
+        // Element name for START and END tokens.
+        std::string_view name() const { return name_; }
+        // Raw text for TEXT token.
+        std::string_view text() const { return text_; }
+        // True if TEXT token comes from CDATA section, such text must not be decoded.
+        bool cdata() const { return cdata_; }
+        // Attributes of last START token.
+        const std::vector<Attribute>& attributes() const { return attributes_; }
+        std::optional<std::string_view> attribute(std::string_view name) const;
+        // Current position in the document.
+        std::size_t offset() const { return position; }
+        // Skips everything up to and including END of the element which START was just read.
+        void skip();
+    private:
+        [[noreturn]] void error(const std::string& message) const;
+        void skip_past(std::string_view terminator);
+        void skip_spaces();
+        std::string_view read_name();
+        void read_start_tag();
+        void read_end_tag();
+
+        std::string_view              document;
+        std::size_t                   position = 0;
+        token_t                       token_ = token_t::END_OF_DOCUMENT;
+        std::string_view              name_;
+        std::string_view              text_;
+        bool                          cdata_ = false;
+        bool                          pending_end = false;
+        std::vector<Attribute>        attributes_;
+        std::vector<std::string_view> open_elements;
+    };
+
+    // Replaces predefined and character entities, unknown entities are kept as is.
+    std::string decode(std::string_view raw);
+    void decode_append(std::string& out, std::string_view raw);
+}
+
+#endif /* WAYLAND_GENERATOR_XMLREADER_H */
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include <cstring>
+
+#include "check.hpp"
+#include "cppbuilder.hpp"
+#include "cpp/arena.hpp"
+
+namespace wg = wayland::generator;
+
+// Builder with arena opens its own scope per interface, it must not reuse memory of the caller's scope.
+int main() {
+    auto protocol = wg::WLProtocol::load_mapped(test::fixture("input.xml"));
+    const auto& pointer = test::interface(protocol, "wl_pointer");
+    auto heap = wg::Builder({}).build(pointer).str();
+
+    wg::Builder::Options options;
+    options.arena = true;
+    wg::Builder builder({}, options);
+
+    cpp::arena_scope outer;
+    constexpr std::size_t size = 4096;
+    auto outer_memory = static_cast<std::byte*>(cpp::current_resource()->allocate(size));
+    std::memset(outer_memory, 0x5a, size);
+
+    auto nested = builder.build(pointer).str();
+    test::check(std::ranges::all_of(outer_memory, outer_memory + size, [](std::byte b) { return b == std::byte{ 0x5a }; }),
+                "memory of outer scope is intact after nested scope");
+    test::check(nested == heap, "nested arena builds the same header");
+
+    // After nested scope ends, outer scope allocates from its own arena again.
+    auto after = cpp::current_resource()->allocate(size);
+    test::check(after != outer_memory, "outer scope continues after its allocations");
+    return test::result();
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <vector>
+
+#include "check.hpp"
+#include "cppbuilder.hpp"
+#include "directbuilder.hpp"
+
+namespace wg = wayland::generator;
+namespace fs = std::filesystem;
+
+// Direct backend is the default, its headers have to stay byte identical to ast backend ones.
+int main() {
+    // The same includes as waylandcpp-generator passes to both backends.
+    std::vector<cpp::include_t> includes;
+    includes.push_back(cpp::AngleInclusion("string"));
+    includes.push_back(cpp::AngleInclusion("vector"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/types.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/socket.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/object_builder.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/wire/buffer_parser.hpp"));
+    includes.push_back(cpp::QuoteInclusion("waylandcpp/callback.hpp"));
+    wg::Builder ast(includes);
+    wg::DirectBuilder direct(includes);
+
+    // Fixtures cover unusual input, fixtures/protocols excerpts of wayland and wayland-protocols the real one.
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(test::fixture(""))) {
+        if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+            files.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(files);
+    test::check(files.size() >= 5, "fixtures and protocol excerpts are found");
+
+    for (const auto& file : files) {
+        auto protocol = wg::WLProtocol::load_mapped(file);
+        test::check(!protocol.interfaces.empty(), std::format("{} has interfaces", file.string()));
+        for (const auto& interface : protocol.interfaces) {
+            auto expected = ast.build(interface).str();
+            auto written = direct.build(interface).str();
+            if (!test::check(expected == written, std::format("{}: headers of '{}' are equal", file.string(), interface.name))) {
+                auto mismatch = std::ranges::mismatch(expected, written).in1 - expected.begin();
+                std::cerr << "ast backend from the first difference:\n" << expected.substr(mismatch, 200) << "\n";
+                std::cerr << "direct backend from the first difference:\n" << written.substr(mismatch, 200) << "\n";
+            }
+        }
+    }
+
+    return test::result();
+}
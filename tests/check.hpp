@@ -0,0 +1,54 @@
+#ifndef WAYLAND_GENERATOR_TESTS_CHECK_H
+#define WAYLAND_GENERATOR_TESTS_CHECK_H
+
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+#include "protocol.hpp"
+
+// Tests are plain executables: every failed check is reported with its line, exit code tells ctest the result.
+namespace test {
+    inline int failures = 0;
+
+    inline bool check(bool condition, std::string_view what, std::source_location location = std::source_location::current()) {
+        if (!condition) {
+            ++failures;
+            std::cerr << std::format("{}:{}: check failed: {}\n", location.file_name(), location.line(), what);
+        }
+        return condition;
+    }
+
+    // Generated text has to contain part verbatim, text is printed on failure to see what was generated instead.
+    inline bool check_contains(std::string_view text, std::string_view part, std::source_location location = std::source_location::current()) {
+        if (!check(text.find(part) != std::string_view::npos, std::format("text contains:\n{}", part), location)) {
+            std::cerr << "generated text:\n" << text << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    inline std::filesystem::path fixture(std::string_view name) {
+        return std::filesystem::path(WAYLANDCPP_GENERATOR_FIXTURES) / name;
+    }
+
+    inline const wayland::generator::WLInterface& interface(const wayland::generator::WLProtocol& protocol, std::string_view name) {
+        for (const auto& interface : protocol.interfaces) {
+            if (interface.name == name) {
+                return interface;
+            }
+        }
+        throw std::runtime_error(std::format("Fixture has no interface '{}'", name));
+    }
+
+    inline int result() {
+        if (failures > 0) {
+            std::cerr << std::format("{} check(s) failed\n", failures);
+        }
+        return failures > 0 ? 1 : 0;
+    }
+}
+
+#endif /* WAYLAND_GENERATOR_TESTS_CHECK_H */
@@ -0,0 +1,92 @@
+#include "check.hpp"
+#include "cppbuilder.hpp"
+
+namespace wg = wayland::generator;
+
+using coalesce_mode = wg::Builder::Options::Coalesce::mode_t;
+
+// Generates every coalesce mode: latest, sum and sum separately per key argument.
+int main() {
+    auto protocol = wg::WLProtocol::load_mapped(test::fixture("input.xml"));
+
+    wg::Builder::Options options;
+    options.coalesce = {
+        { "wl_pointer", "motion", coalesce_mode::LATEST, std::nullopt },
+        { "wl_pointer", "axis", coalesce_mode::SUM, std::nullopt },
+        { "wl_touch", "motion", coalesce_mode::SUM, "id" },
+    };
+    wg::Builder builder({}, options);
+    for (const auto& interface : protocol.interfaces) {
+        builder.validate(interface);
+    }
+
+    auto pointer = builder.build(test::interface(protocol, "wl_pointer")).str();
+    test::check_contains(pointer, "#include <optional>\n#include <tuple>\n#include <utility>\n");
+    // latest
+    test::check_contains(pointer, R"(
+        void coalesce_motion(wire::wire_uint_t time, wire::wire_fixed_t surface_x, wire::wire_fixed_t surface_y) {
+            pending_motion.emplace(time, surface_x, surface_y);
+        }
+)");
+    // sum
+    test::check_contains(pointer, R"(
+        void coalesce_axis(wire::wire_uint_t time, wire::wire_uint_t axis, wire::wire_fixed_t value) {
+            if(!pending_axis)
+                {
+                pending_axis.emplace(time, axis, value);
+                return;
+            }
+            std::get<0>(*pending_axis) = time;
+            std::get<1>(*pending_axis) = axis;
+            std::get<2>(*pending_axis) += value;
+        }
+)");
+    test::check_contains(pointer, "std::optional<std::tuple<wire::wire_uint_t, wire::wire_uint_t, wire::wire_fixed_t>> pending_axis;");
+    test::check_contains(pointer, R"(
+                case motion_op:
+                    {
+                    auto [time_v,surface_x_v,surface_y_v] = body.parse<wire::wire_uint_t,wire::wire_fixed_t,wire::wire_fixed_t>();
+                    coalesce_motion(time_v,surface_x_v,surface_y_v);
+                }
+)");
+    // Other events deliver pending ones first.
+    test::check_contains(pointer, R"(
+                case button_op:
+                    {
+                    flush_coalesced();
+)");
+    test::check_contains(pointer, R"(
+            if(auto pending = std::exchange(pending_motion, std::nullopt))
+            std::apply([this](auto... args) { motion(args...); }, *pending);
+            if(auto pending = std::exchange(pending_axis, std::nullopt))
+            std::apply([this](auto... args) { axis(args...); }, *pending);
+)");
+
+    // sum per key
+    auto touch = builder.build(test::interface(protocol, "wl_touch")).str();
+    test::check_contains(touch, "std::vector<std::tuple<wire::wire_uint_t, wire::wire_int_t, wire::wire_fixed_t, wire::wire_fixed_t>> pending_motion;");
+    test::check_contains(touch, R"(
+        void coalesce_motion(wire::wire_uint_t time, wire::wire_int_t id, wire::wire_fixed_t x, wire::wire_fixed_t y) {
+            for(auto & entry : pending_motion)
+                {
+                if(std::get<1>(entry) == id)
+                    {
+                    std::get<0>(entry) = time;
+                    std::get<2>(entry) += x;
+                    std::get<3>(entry) += y;
+                    return;
+                }
+            }
+            pending_motion.emplace_back(time, id, x, y);
+        }
+)");
+    test::check_contains(touch, "for(const auto & entry : pending_motion)");
+    test::check_contains(touch, "pending_motion.clear();");
+
+    // The same with syntax trees in arena, statements of merged arguments are moved between compound statements.
+    options.arena = true;
+    wg::Builder arena_builder({}, options);
+    test::check(arena_builder.build(test::interface(protocol, "wl_pointer")).str() == pointer, "arena output equals heap output");
+
+    return test::result();
+}
@@ -0,0 +1,62 @@
+#include <fstream>
+
+#include "check.hpp"
+#include "wlstream.hpp"
+
+// Streaming parser over mapped file has to build the same model as boost::property_tree frontend.
+int main() {
+    auto path = test::fixture("frontends.xml");
+    auto reference = wg::WLProtocol::load_ptree(path);
+    auto streamed = wg::WLProtocol::load_mapped(path);
+
+    test::check(reference.name == streamed.name, "protocol names are equal");
+    if (test::check(reference.interfaces.size() == streamed.interfaces.size(), "number of interfaces is equal")) {
+        for (std::size_t i = 0; i < reference.interfaces.size(); ++i) {
+            if (!test::check(reference.interfaces[i] == streamed.interfaces[i], std::format("interface {} is equal", i))) {
+                std::cerr << "ptree:\n" << reference.interfaces[i] << "stream:\n" << streamed.interfaces[i];
+            }
+        }
+    }
+
+    // Both may agree on a wrong model, so decoding is checked as well.
+    test::check(streamed.name == "front&ends", "entity in protocol name");
+    test::check(streamed.interfaces.size() == 3, "commented out interface is skipped");
+    const auto& entities = test::interface(streamed, "fe_entities");
+    test::check(entities.version == 3, "version with spaces");
+    test::check(entities.description.summary == "quotes \"q\", smiley ☺ and ©", "character references in summary");
+    test::check_contains(entities.description.description, "Text & more  after comment");
+    test::check_contains(entities.description.description, "raw &amp; <stuff> kept as is tail &unknown; A");
+    test::check(entities.requests.front().description.summary == "last wins", "last description of message is kept");
+    test::check(entities.requests.front().arguments.front().summary == "single 'quoted'", "single quoted attribute");
+    test::check(entities.events.front().since == 2, "since of event");
+    test::check(entities.events.front().arguments.back().allow_null, "allow-null of argument");
+    test::check(entities.enums.front().entries.back().summary == "entry <two>", "entities in entry summary");
+
+    const auto& missing = test::interface(streamed, "fe_missing");
+    test::check(missing.requests.front().description.summary.empty(), "message without description");
+    test::check(missing.requests.back().arguments.front().summary.empty(), "argument without summary");
+    test::check(!missing.enums.front().entries.front().summary, "entry without summary");
+
+    const auto& cdata = test::interface(streamed, "fe_cdata");
+    test::check(cdata.description.description == "<only> cdata &amp; markup", "description of CDATA only");
+
+    // Unknown argument type is an error of the specification, not of the generator.
+    auto invalid = std::filesystem::temp_directory_path() / "waylandcpp-generator-frontend-test.xml";
+    {
+        std::ofstream out(invalid);
+        out << R"(<protocol name="invalid"><interface name="fe_invalid" version="1"><description summary="s"/>)"
+            << R"(<request name="r"><arg name="a" type="uint32"/></request></interface></protocol>)";
+    }
+    for (auto load : { &wg::WLProtocol::load_ptree, &wg::WLProtocol::load_mapped }) {
+        std::string error;
+        try {
+            load(invalid, nullptr);
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        test::check_contains(error, "Argument type 'uint32' is unknown");
+    }
+    std::filesystem::remove(invalid);
+
+    return test::result();
+}
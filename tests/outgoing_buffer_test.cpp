@@ -0,0 +1,73 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "check.hpp"
+#include "waylandcpp/wire/outgoing_buffer.hpp"
+
+using waylandcpp::wire::OutgoingBuffer;
+
+// Receives one sendmsg, returns number of data bytes and closes received descriptors, counted in fds.
+static std::size_t receive(int socket, std::size_t& fds) {
+    std::array<std::byte, 64> data;
+    alignas(cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * OutgoingBuffer::max_fds)> control;
+    iovec iov{ data.data(), data.size() };
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto received = ::recvmsg(socket, &msg, 0);
+    fds = 0;
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        for (std::size_t i = 0; i < (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int); ++i, ++fds) {
+            int descriptor;
+            std::memcpy(&descriptor, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            ::close(descriptor);
+        }
+    }
+    return received < 0 ? 0 : static_cast<std::size_t>(received);
+}
+
+// Queues more than max_fds descriptors, with and without request bytes which can carry them.
+int main() {
+    int sockets[2];
+    int pipe[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0 || ::pipe(pipe) != 0) {
+        std::cerr << "cannot create socket pair or pipe\n";
+        return 1;
+    }
+
+    {
+        OutgoingBuffer out(sockets[0]);
+        for (std::size_t i = 0; i < OutgoingBuffer::max_fds; ++i) {
+            out.queue_fd(pipe[0]);
+        }
+        bool thrown = false;
+        try {
+            out.queue_fd(pipe[0]);
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        test::check(thrown, "descriptor over max_fds without buffered request is rejected");
+        test::check(out.fd_size() == OutgoingBuffer::max_fds, "queued descriptors are kept");
+
+        // Buffered request carries the full queue, the next descriptor starts a new one.
+        std::uint32_t request = 0x2a;
+        out.queue(&request, sizeof(request));
+        out.queue_fd(pipe[0]);
+        test::check(out.fd_size() == 1, "full queue is sent with buffered request");
+        std::size_t fds = 0;
+        test::check(receive(sockets[1], fds) == sizeof(request), "request is sent");
+        test::check(fds == OutgoingBuffer::max_fds, "max_fds descriptors are sent with request");
+    }
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+    ::close(pipe[0]);
+    ::close(pipe[1]);
+    return test::result();
+}
@@ -0,0 +1,39 @@
+#include "check.hpp"
+#include "cppbuilder.hpp"
+
+namespace wg = wayland::generator;
+
+// Encoding of requests with --static-marshal.
+int main() {
+    auto protocol = wg::WLProtocol::load_mapped(test::fixture("input.xml"));
+
+    wg::Builder::Options options;
+    options.static_marshal = true;
+    wg::Builder builder({}, options);
+
+    // Untyped new_id is interface name, version and id on the wire ("usun"), its size is not known at generation time.
+    const auto& registry = test::interface(protocol, "wl_registry");
+    test::check(wg::message_signature(registry.requests.front()) == "usun", "signature of wl_registry.bind");
+    auto text = builder.build(registry).str();
+    test::check_contains(text, R"(
+        void bind(wire::wire_uint_t name, wire::wire_new_id_t id) {
+            wire::WireObjectBuilder builder(id_, bind_op);
+            builder.add(name, id);
+            sock.write(builder.data(), builder.size());
+        }
+)");
+    test::check(text.find("bind_header") == std::string::npos, "wl_registry.bind has no static header word");
+    test::check(text.find("std::array<wire::wire_word_t") == std::string::npos, "wl_registry.bind is not encoded on stack");
+
+    // Fixed size request: header, serial, surface, hotspot_x and hotspot_y words.
+    text = builder.build(test::interface(protocol, "wl_pointer")).str();
+    test::check_contains(text, R"(
+        void set_cursor(wire::wire_uint_t serial, wire::wire_object_id_t surface, wire::wire_int_t hotspot_x, wire::wire_int_t hotspot_y) {
+            const std::array<wire::wire_word_t, 6> message{ id_, set_cursor_header, serial, surface, static_cast<wire::wire_word_t>(hotspot_x), static_cast<wire::wire_word_t>(hotspot_y) };
+            sock.write(message.data(), sizeof(message));
+        }
+)");
+    test::check_contains(text, "static constexpr wire::wire_word_t set_cursor_header = (0x18 << 16) | set_cursor_op;");
+
+    return test::result();
+}
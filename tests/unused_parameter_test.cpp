@@ -0,0 +1,29 @@
+#include "check.hpp"
+#include "cppbuilder.hpp"
+
+namespace wg = wayland::generator;
+
+// Generated headers are compiled by users with -Wextra, parameters which aren't read stay unnamed.
+int main() {
+    auto protocol = wg::WLProtocol::load_mapped(test::fixture("input.xml"));
+    const auto& pointer = test::interface(protocol, "wl_pointer");
+
+    wg::Builder::Options options;
+    options.corked = true;
+    options.fd_queue = true;
+    auto switched = wg::Builder({}, options).build(pointer).str();
+    test::check_contains(switched, "void dispatch(wire::wire_op_t op, wire::WireBufferParser & body, wire::FdRing & /*fds*/) {");
+
+    options.table_dispatch = true;
+    auto table = wg::Builder({}, options).build(pointer).str();
+    test::check_contains(table, "void dispatch(wire::wire_op_t op, wire::WireBufferParser & body, wire::FdRing & fds) {");
+    test::check_contains(table, "static void decode_motion(wl_pointer & self, wire::WireBufferParser & body, wire::FdRing & /*fds*/) {");
+    test::check_contains(table, "static void decode_frame(wl_pointer & self, wire::WireBufferParser & /*body*/, wire::FdRing & /*fds*/) {");
+    test::check_contains(table, "virtual void unknown_opcode(wire::wire_op_t /*op*/) {");
+
+    options.compact = true;
+    auto compact = wg::Builder({}, options).build(pointer).str();
+    test::check_contains(compact, "void unknown_opcode(wire::wire_op_t op) {");
+
+    return test::result();
+}